@@ -0,0 +1,91 @@
+/*
+ * c_fuzzy,
+ *
+ *
+ * Copyright (C) 2014 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of c_fuzzy.
+ *
+ * c_fuzzy is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * c_fuzzy is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with c_fuzzy.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLASSIFICATIONENGINE_H_
+#define CLASSIFICATIONENGINE_H_
+
+#include <vector>
+#include <map>
+#include <string>
+#include <ostream>
+#include <cstdint>
+
+#include "ClassifierReasoner.h"
+
+#include "c_fuzzy/Classification.h"
+#include "c_fuzzy/BatchClassification.h"
+#include "c_fuzzy/CompactClassification.h"
+#include "c_fuzzy/ClassificationSchema.h"
+
+//classifier loaded in the calling process, shared by the service and the nodes
+class ClassificationEngine
+{
+public:
+	ClassificationEngine(const std::string& knowledgeBasePath,
+				const std::string& classifierPath, size_t cacheSize = 0,
+				int cacheQuantization = 1);
+
+	void classify(c_fuzzy::Classification::Request& request,
+				c_fuzzy::Classification::Response& response);
+	void classify(c_fuzzy::BatchClassification::Request& request,
+				c_fuzzy::BatchClassification::Response& response);
+	void classify(c_fuzzy::CompactClassification::Request& request,
+				c_fuzzy::CompactClassification::Response& response);
+	void getSchema(c_fuzzy::ClassificationSchema::Response& response);
+
+	inline uint64_t getSchemaVersion()
+	{
+		return schemaVersion;
+	}
+
+	void drawReasoningGraph(std::ostream& stream);
+	void drawDependencyGraph(std::ostream& stream);
+	void drawPlan(std::ostream& stream);
+	ClassificationCache* getCache();
+
+	~ClassificationEngine();
+
+private:
+	void addInputs(std::vector<c_fuzzy::InputObject>& inputs);
+	void sendOutputs(const InstanceClassification& results,
+				std::vector<c_fuzzy::ObjectClassification>& outputs);
+	void addInputs(std::vector<c_fuzzy::CompactObject>& inputs);
+	void sendOutputs(const InstanceClassification& results,
+				std::vector<c_fuzzy::CompactOutput>& outputs);
+	static void hashNames(const std::vector<std::string>& names,
+				uint64_t& hash);
+
+private:
+	FuzzyKnowledgeBase* knowledgeBase;
+	FuzzyClassifier* classifier;
+	ClassifierReasoner* reasoner;
+
+	//class table of the compact messages
+	std::vector<std::string> classNames;
+	std::map<std::string, uint16_t> classIndices;
+	uint64_t schemaVersion;
+	static constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
+	static constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+};
+
+#endif /* CLASSIFICATIONENGINE_H_ */
@@ -27,9 +27,10 @@
 #include <vector>
 #include <string>
 
-#include "ClassifierReasoner.h"
+#include "ClassificationEngine.h"
 
 #include "c_fuzzy/Classification.h"
+#include "c_fuzzy/BatchClassification.h"
 #include "c_fuzzy/Graph.h"
 
 #include <ros/ros.h>
@@ -39,32 +40,39 @@ class ClassifierServiceHandler
 public:
 	ClassifierServiceHandler(ros::NodeHandle& n,
 				const std::string& knowledgeBasePath,
-				const std::string& classifierPath);
+				const std::string& classifierPath, size_t cacheSize = 0,
+				int cacheQuantization = 1);
 
 	bool classificationCallback(c_fuzzy::Classification::Request& request,
 				c_fuzzy::Classification::Response& response);
+	bool batchClassificationCallback(
+				c_fuzzy::BatchClassification::Request& request,
+				c_fuzzy::BatchClassification::Response& response);
+	bool compactClassificationCallback(
+				c_fuzzy::CompactClassification::Request& request,
+				c_fuzzy::CompactClassification::Response& response);
+	bool schemaRequestCallback(
+				c_fuzzy::ClassificationSchema::Request& request,
+				c_fuzzy::ClassificationSchema::Response& response);
 
 	bool reasoningGraphRequestCallback(c_fuzzy::Graph::Request& request,
 				c_fuzzy::Graph::Response& response);
 	bool dependencyGraphRequestCallback(c_fuzzy::Graph::Request& request,
 				c_fuzzy::Graph::Response& response);
+	bool reasoningPlanRequestCallback(c_fuzzy::Graph::Request& request,
+				c_fuzzy::Graph::Response& response);
 	~ClassifierServiceHandler();
 
 private:
-	FuzzyKnowledgeBase* knowledgeBase;
-	FuzzyClassifier* classifier;
-	ClassifierReasoner* reasoner;
+	ClassificationEngine* engine;
 
 	ros::ServiceServer classifierService;
+	ros::ServiceServer batchService;
+	ros::ServiceServer compactService;
+	ros::ServiceServer schemaService;
 	ros::ServiceServer rGraphService;
 	ros::ServiceServer dGraphService;
-
-private:
-
-	void addInputs(std::vector<ObjectInstance>& objects,
-				std::vector<c_fuzzy::InputObject>& inputs);
-	void sendOutputs(const InstanceClassification& results,
-				c_fuzzy::Classification::Response& response);
+	ros::ServiceServer planService;
 };
 
 #endif /* CLASSIFIERSERVICEHANDLER_H_ */
@@ -40,6 +40,8 @@ public:
 	std::string getKnowledgeBase();
 	std::string getClassifier();
 	std::string getClassifierKnowledgeBase();
+	size_t getCacheSize();
+	int getCacheQuantization();
 
 	bool hasReasoner();
 	bool hasClassifier();
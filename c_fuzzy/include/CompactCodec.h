@@ -0,0 +1,61 @@
+/*
+ * c_fuzzy,
+ *
+ *
+ * Copyright (C) 2014 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of c_fuzzy.
+ *
+ * c_fuzzy is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * c_fuzzy is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with c_fuzzy.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPACTCODEC_H_
+#define COMPACTCODEC_H_
+
+#include <vector>
+#include <map>
+#include <string>
+#include <cstdint>
+
+#include "c_fuzzy/InputObject.h"
+#include "c_fuzzy/ObjectClassification.h"
+#include "c_fuzzy/CompactGroup.h"
+#include "c_fuzzy/CompactGroupOutput.h"
+#include "c_fuzzy/ClassificationSchema.h"
+
+//client side translation between named and packed classification messages
+class CompactCodec
+{
+public:
+	CompactCodec(const c_fuzzy::ClassificationSchema::Response& schema);
+
+	void encode(double threshold, uint32_t topK,
+				const std::vector<c_fuzzy::InputObject>& objects,
+				c_fuzzy::CompactGroup& group);
+	bool decode(const c_fuzzy::CompactGroupOutput& output,
+				std::vector<c_fuzzy::ObjectClassification>& results);
+
+	inline uint64_t getVersion() const
+	{
+		return version;
+	}
+
+private:
+	std::map<std::string, uint16_t> columns;
+	std::vector<std::string> classes;
+	uint64_t version;
+};
+
+#endif /* COMPACTCODEC_H_ */
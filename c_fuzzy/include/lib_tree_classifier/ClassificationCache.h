@@ -0,0 +1,72 @@
+/*
+ * c_fuzzy,
+ *
+ *
+ * Copyright (C) 2014 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of c_fuzzy.
+ *
+ * c_fuzzy is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * c_fuzzy is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with c_fuzzy.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLASSIFICATIONCACHE_H_
+#define CLASSIFICATIONCACHE_H_
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <cstddef>
+
+/**
+ * Bounded LRU cache of class rule truth values.
+ * The key is the vector of values fed to a class rule, prefixed by the
+ * class index.
+ */
+class ClassificationCache
+{
+public:
+	typedef std::vector<int> Key;
+
+private:
+	struct KeyHash
+	{
+		size_t operator()(const Key& key) const;
+	};
+
+	typedef std::pair<Key, double> CacheEntry;
+	typedef std::list<CacheEntry> LruList;
+	typedef std::unordered_map<Key, LruList::iterator, KeyHash> CacheMap;
+
+public:
+	ClassificationCache(size_t capacity);
+	bool lookup(const Key& key, double& truth);
+	void insert(const Key& key, double truth);
+	void clear();
+
+	size_t size();
+	size_t getHits();
+	size_t getMisses();
+
+private:
+	size_t capacity;
+	LruList lruList;
+	CacheMap cacheMap;
+
+	size_t hits;
+	size_t misses;
+};
+
+#endif /* CLASSIFICATIONCACHE_H_ */
@@ -30,6 +30,10 @@
 #include <set>
 #include <iostream>
 
+#include <boost/dynamic_bitset.hpp>
+
+#include "InstanceTable.h"
+
 typedef std::map<std::string, int> ObjectProperties;
 typedef std::map<std::string, double> ClassificationMap;
 typedef std::map<size_t, ClassificationMap> InstanceClassification;
@@ -51,22 +55,19 @@ inline std::ostream& operator<<(std::ostream& os,
 	return os;
 }
 
-struct ObjectInstance
-{
-	size_t id;
-	ObjectProperties properties;
-};
-
-typedef std::set<ObjectInstance*> ObjectList;
+//sets of instances, indexed by instance table row
+typedef boost::dynamic_bitset<> ObjectList;
 typedef std::map<std::string, ObjectList> ObjectListMap;
-typedef std::map<std::string, ObjectInstance*> ObjectMap;
+typedef std::map<std::string, size_t> ObjectMap;
 
-typedef std::set<size_t> TabuList;
+typedef boost::dynamic_bitset<> TabuList;
 
 struct ClassificationData
 {
-	ClassificationData(ObjectListMap& candidates,
+	ClassificationData(InstanceTable& instances, ObjectListMap& candidates,
 				InstanceClassification& results) :
+				tabuList(instances.size()), bound(1.0), batchClass(NULL),
+				batchValues(NULL), batchDepth(0), instances(instances),
 				candidates(candidates), results(results)
 	{
 	}
@@ -76,7 +77,18 @@ struct ClassificationData
 	ObjectMap dependencyMap;
 	TabuList tabuList;
 
+	//branch and bound data
+	ClassificationMap levels;
+	std::set<std::string> deferred;
+	double bound;
+
+	//relation features computed in batch for the current dependency
+	const std::string* batchClass;
+	const int* batchValues;
+	size_t batchDepth;
+
 	//Global classification data
+	InstanceTable& instances;
 	ObjectListMap& candidates;
 	InstanceClassification& results;
 };
@@ -27,69 +27,187 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <set>
+#include <functional>
+#include <ostream>
 
 #include "FuzzyKnowledgeBase.h"
 #include "FuzzyClassifier.h"
 #include "FuzzyReasoner.h"
 #include "VariableGenerator.h"
 #include "ClassificationData.h"
+#include "InstanceTable.h"
+#include "ClassificationCache.h"
+
+//counters of the work done by the reasoner
+struct ReasonerStats
+{
+	ReasonerStats()
+	{
+		combinations = 0;
+		evaluations = 0;
+		pruned = 0;
+	}
+
+	size_t combinations;
+	size_t evaluations;
+	size_t pruned;
+};
+
+//recent acceptance rate of a class rule, used to order the reasoning
+struct ClassStatistics
+{
+	ClassStatistics()
+	{
+		selectivity = 1.0;
+		evaluations = 0;
+		accepted = 0;
+	}
+
+	double selectivity;
+	size_t evaluations;
+	size_t accepted;
+};
+
+//a class of a reasoning component, in nesting order
+struct PlanStep
+{
+	std::string className;
+	size_t candidates;
+	double selectivity;
+	std::vector<std::string> dependencies;
+};
+
+typedef std::vector<PlanStep> ComponentPlan;
 
 class ClassifierReasoner
 {
 private:
 	typedef std::vector<std::string> DepList;
 	typedef std::map<std::string, DepList> DepLists;
+	typedef std::vector<std::pair<std::string, FuzzyClass*> > ClassPlan;
+	typedef std::vector<std::pair<size_t, Variable> > ClassInputs;
+	typedef std::map<std::string, ClassInputs> ClassInputTable;
+	typedef std::vector<size_t> RowVector;
+
 public:
 	ClassifierReasoner(FuzzyClassifier& classifier,
 				FuzzyKnowledgeBase& knowledgeBase);
-	void addInstance(ObjectInstance* instance);
-	InstanceClassification run(double thresold);
+	size_t addInstance(size_t id);
+	void setProperty(size_t row, const std::string& name, int value);
+	void setProperty(size_t row, size_t column, int value);
+	const InstanceSchema& getSchema();
+	void setCache(size_t capacity, int quantization);
+	ClassificationCache* getCache();
+	InstanceClassification run(double thresold, bool bypassCache = false,
+				size_t topK = 0);
+	const ReasonerStats& getStats();
+	void resetStats();
+	void drawPlan(std::ostream& stream);
+	~ClassifierReasoner();
 
 private:
 	//threshold normalization
 	void setThreshold(double thr);
 
+	//per-frame tables
+	void setupTables();
+
 	//instance retrival
 	void getClassCandidates(FuzzyClass* fuzzyClass, ObjectList& candidates);
 	ObjectList& getSuperClassCandidates(FuzzyClass* fuzzyClass);
-	bool hasClassVariables(ObjectInstance& instance, FuzzyClass& fuzzyClass);
 	void getCandidates(ClassList& classList, ObjectListMap& candidates,
 				DepLists& deps);
 	ObjectList& getDependencyObjects(const std::string& className,
 				const std::string& dependencyName, ClassificationData& data);
 
+	//query planning
+	void planComponent(ClassList& classList, ObjectListMap& candidates,
+				DepLists& deps, ClassPlan& plan);
+	double getCost(const std::string& className, ObjectListMap& candidates);
+	size_t getDependencySize(const std::string& className,
+				const std::string& dependencyName, ObjectListMap& candidates);
+	void updateStatistics();
+
 	//classification
-	void classify(ClassList& classList, DepLists& deps,
-				ObjectListMap& candidates, InstanceClassification& results);
-	void trivialClassify(ClassList::iterator current, ClassificationData& data);
-	void recursiveClassify(ClassList::iterator current, ClassList::iterator end,
+	void classify(ClassPlan& plan, DepLists& deps, ObjectListMap& candidates,
+				InstanceClassification& results);
+	void trivialClassify(ClassPlan::iterator current, ClassificationData& data);
+	void recursiveClassify(ClassPlan::iterator current, ClassPlan::iterator end,
 				DepLists& deps, ClassificationData& data);
-	void recursiveClassify(ClassList::iterator current, ClassList::iterator end,
+	void recursiveClassify(ClassPlan::iterator current, ClassPlan::iterator end,
 				DepList::iterator currentDep, DepList::iterator endDep,
 				DepLists& deps, ClassificationData& data);
 	void classifyInstances(ClassificationData& data);
-	void setupReasoning(ClassificationData& data);
-	void runReasoning(ClassificationData& data);
+	void setResults(double truthValue, ClassificationData& data);
 	double getMembershipLevel(size_t id, FuzzyClass* fuzzyClass, double level,
 				ClassificationData& data);
-	double getMinTruthValue(OutputTable& result, ClassificationData& data);
+
+	//branch and bound
+	void evaluateClosedClasses(DepLists& deps, ClassificationData& data,
+				DepList& closed);
+	bool isClosed(const std::string& className, DepLists& deps,
+				ClassificationData& data);
+	double evaluateClass(const std::string& className, size_t row,
+				ClassificationData& data);
+
+	//relation features
+	bool prepareBatch(const std::string& className,
+				const std::string& dependencyName, ObjectList& objects,
+				DepLists& deps, std::vector<int>& values,
+				ClassificationData& data);
+	const int* getGeneratedValues(const std::string& className,
+				ClassificationData& data);
+
+	//cache management
+	bool lookupCache(const std::string& className, size_t row,
+				const int* generated, size_t size, double& truth);
 
 	//Flag management
 	void deleteHidden(InstanceClassification& results);
 
+	//top-k classification
+	void pruneTopK(ClassList& classList, ObjectListMap& candidates,
+				InstanceClassification& results, size_t topK);
+	void keepBest(InstanceClassification& results, size_t topK);
+
 	//tabu list management
-	bool hasBeenConsidered(ObjectInstance* instance, ClassificationData& data);
-	void noMoreConsidered(ObjectInstance* instance, ClassificationData& data);
+	bool hasBeenConsidered(size_t index, ClassificationData& data);
+	void noMoreConsidered(size_t index, ClassificationData& data);
 
 private:
 	FuzzyClassifier& classifier;
 	FuzzyKnowledgeBase& knowledgeBase;
-	ObjectList inputs;
+	InstanceTable instances;
+	ObjectList inputMask;
 	FuzzyReasoner* reasoner;
 	GeneratedVarTable genVarTable;
 
 	ObjectListMap table;
+	ClassInputTable classInputs;
+	std::set<std::string> hiddenClasses;
+	std::set<std::string> prunableClasses;
 	double threshold;
+
+	//membership level of each row, one column per class index
+	std::vector<std::vector<double> > levelColumns;
+
+	//classification cache
+	ClassificationCache* cache;
+	ClassificationCache::Key cacheKey;
+	std::map<std::string, int> classIndices;
+	std::vector<int> generatedValues;
+	RowVector batchRows;
+	std::vector<std::vector<int> > batchBuffers;
+	int quantization;
+	bool useCache;
+
+	ReasonerStats stats;
+
+	//query planner statistics
+	std::map<std::string, ClassStatistics> classStats;
+	std::vector<ComponentPlan> lastPlan;
+	static constexpr double SELECTIVITY_DECAY = 0.2;
 };
 
 #endif /* CLASSIFIERREASONER_H_ */
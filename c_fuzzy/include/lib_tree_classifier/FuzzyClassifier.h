@@ -31,6 +31,7 @@
 
 #include "DependencyGraph.h"
 #include "FuzzyClass.h"
+#include "InstanceTable.h"
 
 typedef std::map<std::string, FuzzyClass*> ClassList;
 typedef std::vector<ClassList> ReasoningList;
@@ -48,6 +49,7 @@ public:
 	ClassList::iterator end();
 	ReasoningList::iterator beginReasoning();
 	ReasoningList::iterator endReasoning();
+	const InstanceSchema& getSchema();
 
 	~FuzzyClassifier();
 
@@ -63,6 +65,7 @@ private:
 	DependencyGraph dGraph;
 	ReasoningGraph* rGraph;
 	ReasoningList reasoningList;
+	InstanceSchema schema;
 };
 
 #endif /* FUZZYCLASSIFIER_H_ */
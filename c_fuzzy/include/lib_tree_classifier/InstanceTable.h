@@ -0,0 +1,93 @@
+/*
+ * c_fuzzy,
+ *
+ *
+ * Copyright (C) 2014 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of c_fuzzy.
+ *
+ * c_fuzzy is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * c_fuzzy is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with c_fuzzy.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INSTANCETABLE_H_
+#define INSTANCETABLE_H_
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include <boost/dynamic_bitset.hpp>
+
+/**
+ * The set of instance variables declared by the classifier.
+ * Each variable is mapped to a column of the instance table.
+ */
+class InstanceSchema
+{
+public:
+	size_t addVariable(const std::string& name);
+	bool contains(const std::string& name) const;
+	size_t getColumn(const std::string& name) const;
+	const std::string& getName(size_t column) const;
+	size_t size() const;
+
+private:
+	std::map<std::string, size_t> columns;
+	std::vector<std::string> names;
+};
+
+/**
+ * Column based storage of the instances of a frame.
+ * Each row is an instance, each column a schema variable; a presence bitmap
+ * per column records which instances have a value for that variable.
+ */
+class InstanceTable
+{
+public:
+	InstanceTable(const InstanceSchema& schema);
+	size_t addRow(size_t id);
+	void setValue(size_t row, size_t column, int value);
+	const boost::dynamic_bitset<>& getPresence(size_t column) const;
+	size_t size() const;
+	void clear();
+
+	inline int getValue(size_t row, size_t column) const
+	{
+		return columns[column][row];
+	}
+
+	inline bool hasValue(size_t row, size_t column) const
+	{
+		return presence[column][row];
+	}
+
+	inline size_t getId(size_t row) const
+	{
+		return ids[row];
+	}
+
+	inline const InstanceSchema& getSchema() const
+	{
+		return schema;
+	}
+
+private:
+	const InstanceSchema& schema;
+	std::vector<size_t> ids;
+	std::vector<std::vector<int> > columns;
+	std::vector<boost::dynamic_bitset<> > presence;
+};
+
+#endif /* INSTANCETABLE_H_ */
@@ -45,7 +45,8 @@ class RuleBuilder
 private:
 	typedef std::pair<NodePtr, Variable> ConstraintBuilt;
 public:
-	RuleBuilder(FuzzyKnowledgeBase& knowledgeBase);
+	RuleBuilder(FuzzyKnowledgeBase& knowledgeBase,
+				const InstanceSchema& schema);
 	VariableGenerator* buildClassRule(FuzzyClass& fuzzyClass);
 
 private:
@@ -66,6 +67,7 @@ private:
 
 private:
 	FuzzyKnowledgeBase& knowledgeBase;
+	const InstanceSchema& schema;
 
 	//data needed to build rules
 	std::string currentClass;
@@ -26,88 +26,129 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include "Variable.h"
 #include "ClassificationData.h"
+#include "InstanceTable.h"
 
 
 class VariableGenerator
 {
 private:
-	struct MatchVar
+	//an object of the combination, looked up once per evaluation
+	struct Slot
 	{
-		MatchVar()
+		Slot(std::string className, bool dependency) :
+					className(className), dependency(dependency)
 		{
 		}
+		std::string className;
+		bool dependency;
+	};
 
-		MatchVar(Variable var, Variable target) :
-					var(var), target(target)
+	//a class variable, resolved to its slot and instance table column
+	struct ColumnVar
+	{
+		ColumnVar()
+		{
+			slot = 0;
+			column = 0;
+		}
+
+		ColumnVar(size_t slot, size_t column) :
+					slot(slot), column(column)
 		{
 		}
-		Variable var;
-		Variable target;
+		size_t slot;
+		size_t column;
 	};
 
-	struct OnVar
+	struct MatchVar
 	{
-		OnVar()
+		MatchVar(ColumnVar var, ColumnVar target) :
+					var(var), target(target)
 		{
 		}
+		ColumnVar var;
+		ColumnVar target;
+	};
 
-		OnVar(Variable var, Variable min, Variable max) :
+	struct OnVar
+	{
+		OnVar(ColumnVar var, ColumnVar min, ColumnVar max) :
 					var(var), min(min), max(max)
 		{
 		}
-		Variable min;
-		Variable max;
-		Variable var;
+		ColumnVar min;
+		ColumnVar max;
+		ColumnVar var;
 	};
 
 	struct InverseVar
 	{
-		InverseVar()
-		{
-		}
-
-		InverseVar(Variable min, Variable max, Variable target) :
+		InverseVar(ColumnVar min, ColumnVar max, ColumnVar target) :
 					min(min), max(max), target(target)
 		{
 		}
-		Variable min;
-		Variable max;
-		Variable target;
+		ColumnVar min;
+		ColumnVar max;
+		ColumnVar target;
 	};
 
-	typedef std::map<std::string, MatchVar> MatchVarMap;
-	typedef std::map<std::string, OnVar> OnVarMap;
-	typedef std::map<std::string, InverseVar> InverseVarMap;
+	typedef std::vector<MatchVar> MatchVarList;
+	typedef std::vector<OnVar> OnVarList;
+	typedef std::vector<InverseVar> InverseVarList;
+
+public:
+	typedef std::vector<size_t> RowVector;
 
 public:
-	VariableGenerator();
+	VariableGenerator(const std::string& className,
+				const InstanceSchema& schema);
 	std::string addMatchVariable(Variable var, Variable target);
 	std::string addOnVariable(Variable var, Variable min, Variable max);
 	std::string addInverseOnVariable(Variable min, Variable max,
 				Variable target);
 
-	ObjectProperties getGeneratedProperties(ObjectMap& candidates, ObjectMap& dependencies);
+	const std::vector<Variable>& getGeneratedVariables();
+	void getGeneratedValues(const InstanceTable& instances,
+				ObjectMap& candidates, ObjectMap& dependencies,
+				std::vector<int>& values);
+	void getGeneratedValues(const InstanceTable& instances,
+				ObjectMap& candidates, ObjectMap& dependencies,
+				const std::string& dependency, const RowVector& rows,
+				std::vector<int>& values);
 
 private:
-	void generateMatches(ObjectProperties& generated);
-	void generateOns(ObjectProperties& generated);
-	void generateInverses(ObjectProperties& generated);
-	int getValue(ObjectMap& inputs, Variable var);
-	int getValue(Variable var);
-	int getDepValue(Variable var);
-	ObjectMap* findObject();
+	void resolveSlots(ObjectMap& candidates, ObjectMap& dependencies,
+				const std::string* dependency);
+	void generate(const InstanceTable& instances, size_t batchRow,
+				int* values);
+	ColumnVar getColumnVar(const Variable& var, bool dependency);
 	std::string getNewVar();
+
+	inline int getValue(const InstanceTable& instances, const ColumnVar& var,
+				size_t batchRow)
+	{
+		size_t row = batchSlots[var.slot] ? batchRow : slotRows[var.slot];
+		return instances.getValue(row, var.column);
+	}
+
 private:
-	MatchVarMap matchVars;
-	OnVarMap onVars;
-	InverseVarMap inverseVars;
+	std::string className;
+	const InstanceSchema& schema;
+
+	MatchVarList matchVars;
+	OnVarList onVars;
+	InverseVarList inverseVars;
 	size_t varCounter;
 
+	std::vector<Slot> slots;
+	std::vector<Variable> generatedVariables;
+
 	//Helper members
-	ObjectMap* currentCandidates;
-	ObjectMap* currentDependecies;
+	std::vector<size_t> slotRows;
+	std::vector<char> batchSlots;
 
 };
 
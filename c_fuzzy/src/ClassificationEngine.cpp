@@ -0,0 +1,232 @@
+/*
+ * c_fuzzy,
+ *
+ *
+ * Copyright (C) 2014 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of c_fuzzy.
+ *
+ * c_fuzzy is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * c_fuzzy is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with c_fuzzy.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ClassificationEngine.h"
+#include "FuzzyBuilder.h"
+#include "TreeClassifierBuilder.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace c_fuzzy;
+
+ClassificationEngine::ClassificationEngine(const string& knowledgeBasePath,
+			const string& classifierPath, size_t cacheSize,
+			int cacheQuantization)
+{
+	FuzzyBuilder kbBuilder;
+	TreeClassifierBuilder classifierBuilder;
+
+	classifierBuilder.parse(classifierPath.c_str());
+	classifier = classifierBuilder.buildFuzzyClassifier();
+
+	kbBuilder.parse(knowledgeBasePath.c_str());
+	knowledgeBase = kbBuilder.createKnowledgeBase();
+
+	reasoner = new ClassifierReasoner(*classifier, *knowledgeBase);
+	reasoner->setCache(cacheSize, cacheQuantization);
+
+	for (auto& i : *classifier)
+	{
+		classIndices[i.first] = classNames.size();
+		classNames.push_back(i.first);
+	}
+
+	ClassificationSchema::Response schema;
+	getSchema(schema);
+	schemaVersion = schema.version;
+}
+
+void ClassificationEngine::classify(Classification::Request& request,
+			Classification::Response& response)
+{
+	addInputs(request.objects);
+	const InstanceClassification& results = reasoner->run(request.threshold,
+				request.bypassCache, request.topK);
+	sendOutputs(results, response.results);
+}
+
+void ClassificationEngine::classify(BatchClassification::Request& request,
+			BatchClassification::Response& response)
+{
+	//groups are independent, the reasoner and its cache are shared
+	response.results.resize(request.groups.size());
+	for (size_t i = 0; i < request.groups.size(); i++)
+	{
+		ClassificationGroup& group = request.groups[i];
+		GroupClassification& output = response.results[i];
+
+		addInputs(group.objects);
+		const InstanceClassification& results = reasoner->run(group.threshold,
+					request.bypassCache, group.topK);
+		output.id = group.id;
+		sendOutputs(results, output.results);
+	}
+}
+
+void ClassificationEngine::classify(CompactClassification::Request& request,
+			CompactClassification::Response& response)
+{
+	response.results.resize(request.groups.size());
+	for (size_t i = 0; i < request.groups.size(); i++)
+	{
+		CompactGroup& group = request.groups[i];
+		CompactGroupOutput& output = response.results[i];
+
+		addInputs(group.objects);
+		const InstanceClassification& results = reasoner->run(group.threshold,
+					request.bypassCache, group.topK);
+		output.id = group.id;
+		sendOutputs(results, output.results);
+	}
+}
+
+void ClassificationEngine::getSchema(ClassificationSchema::Response& response)
+{
+	const InstanceSchema& schema = reasoner->getSchema();
+	for (size_t column = 0; column < schema.size(); column++)
+	{
+		response.variables.push_back(schema.getName(column));
+	}
+
+	response.classes = classNames;
+
+	//any change of the tables changes the version
+	uint64_t hash = FNV_OFFSET;
+	hashNames(response.variables, hash);
+	hashNames(response.classes, hash);
+	response.version = hash;
+}
+
+void ClassificationEngine::drawReasoningGraph(ostream& stream)
+{
+	classifier->drawReasoningGraph(stream);
+}
+
+void ClassificationEngine::drawDependencyGraph(ostream& stream)
+{
+	classifier->drawDependencyGraph(stream);
+}
+
+void ClassificationEngine::drawPlan(ostream& stream)
+{
+	reasoner->drawPlan(stream);
+}
+
+ClassificationCache* ClassificationEngine::getCache()
+{
+	return reasoner->getCache();
+}
+
+ClassificationEngine::~ClassificationEngine()
+{
+	delete reasoner;
+	delete classifier;
+	delete knowledgeBase;
+}
+
+void ClassificationEngine::addInputs(vector<InputObject>& inputs)
+{
+	for (size_t i = 0; i < inputs.size(); i++)
+	{
+		InputObject& input = inputs[i];
+		size_t row = reasoner->addInstance(input.id);
+		vector<InputVariable>& map = input.variables;
+		for (auto& inputVariable : map)
+		{
+			reasoner->setProperty(row, inputVariable.name, inputVariable.value);
+		}
+	}
+}
+
+void ClassificationEngine::sendOutputs(const InstanceClassification& results,
+			vector<ObjectClassification>& outputs)
+{
+	for (InstanceClassification::const_iterator it = results.begin();
+				it != results.end(); ++it)
+	{
+		outputs.push_back(ObjectClassification());
+		ObjectClassification& classification = outputs.back();
+		classification.id = it->first;
+		const ClassificationMap& map = it->second;
+		for (ClassificationMap::const_iterator j = map.begin(); j != map.end();
+					j++)
+		{
+			classification.classifications.push_back(ClassificationOutput());
+			ClassificationOutput& out = classification.classifications.back();
+			out.className = j->first;
+			out.membership = j->second;
+		}
+	}
+}
+
+void ClassificationEngine::addInputs(vector<CompactObject>& inputs)
+{
+	size_t columns = reasoner->getSchema().size();
+
+	for (auto& input : inputs)
+	{
+		size_t row = reasoner->addInstance(input.id);
+		size_t size = min(input.columns.size(), input.values.size());
+		for (size_t k = 0; k < size; k++)
+		{
+			//columns unknown to the schema are ignored, like unknown names
+			if (input.columns[k] < columns)
+				reasoner->setProperty(row, input.columns[k], input.values[k]);
+		}
+	}
+}
+
+void ClassificationEngine::hashNames(const vector<string>& names,
+			uint64_t& hash)
+{
+	//FNV-1a, each name is terminated by a zero byte
+	for (auto& name : names)
+	{
+		for (char c : name)
+			hash = (hash ^ static_cast<unsigned char>(c)) * FNV_PRIME;
+
+		hash *= FNV_PRIME;
+	}
+
+	//the table end, so that names cannot move between the tables
+	hash = (hash ^ 0xff) * FNV_PRIME;
+}
+
+void ClassificationEngine::sendOutputs(const InstanceClassification& results,
+			vector<CompactOutput>& outputs)
+{
+	outputs.resize(results.size());
+	size_t i = 0;
+
+	for (auto& result : results)
+	{
+		CompactOutput& output = outputs[i++];
+		output.id = result.first;
+		for (auto& classification : result.second)
+		{
+			output.classes.push_back(classIndices[classification.first]);
+			output.memberships.push_back(classification.second);
+		}
+	}
+}
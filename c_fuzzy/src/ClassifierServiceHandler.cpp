@@ -26,8 +26,6 @@
 #include <string>
 
 #include "ClassifierServiceHandler.h"
-#include "FuzzyBuilder.h"
-#include "TreeClassifierBuilder.h"
 
 #include <iostream>
 #include <sstream>
@@ -38,21 +36,23 @@ using namespace std;
 using namespace c_fuzzy;
 
 ClassifierServiceHandler::ClassifierServiceHandler(ros::NodeHandle& n,
-			const string& knowledgeBasePath, const string& classifierPath)
+			const string& knowledgeBasePath, const string& classifierPath,
+			size_t cacheSize, int cacheQuantization)
 {
-	FuzzyBuilder kbBuilder;
-	TreeClassifierBuilder classifierBuilder;
+	engine = new ClassificationEngine(knowledgeBasePath, classifierPath,
+				cacheSize, cacheQuantization);
 
-	classifierBuilder.parse(classifierPath.c_str());
-	classifier = classifierBuilder.buildFuzzyClassifier();
+	classifierService = n.advertiseService("classification",
+				&ClassifierServiceHandler::classificationCallback, this);
 
-	kbBuilder.parse(knowledgeBasePath.c_str());
-	knowledgeBase = kbBuilder.createKnowledgeBase();
+	batchService = n.advertiseService("batchClassification",
+				&ClassifierServiceHandler::batchClassificationCallback, this);
 
-	reasoner = new ClassifierReasoner(*classifier, *knowledgeBase);
+	compactService = n.advertiseService("compactClassification",
+				&ClassifierServiceHandler::compactClassificationCallback, this);
 
-	classifierService = n.advertiseService("classification",
-				&ClassifierServiceHandler::classificationCallback, this);
+	schemaService = n.advertiseService("getClassificationSchema",
+				&ClassifierServiceHandler::schemaRequestCallback, this);
 
 	rGraphService = n.advertiseService("getReasoningGraph",
 				&ClassifierServiceHandler::reasoningGraphRequestCallback, this);
@@ -60,6 +60,9 @@ ClassifierServiceHandler::ClassifierServiceHandler(ros::NodeHandle& n,
 	dGraphService = n.advertiseService("getDependencyGraph",
 				&ClassifierServiceHandler::dependencyGraphRequestCallback,
 				this);
+
+	planService = n.advertiseService("getReasoningPlan",
+				&ClassifierServiceHandler::reasoningPlanRequestCallback, this);
 }
 
 bool ClassifierServiceHandler::classificationCallback(
@@ -69,16 +72,63 @@ bool ClassifierServiceHandler::classificationCallback(
 	ROS_DEBUG_STREAM(
 				"Number of objects to classify: " << request.objects.size());
 	clock_t begin = clock();
-	vector<InputObject>& inputs = request.objects;
-	vector<ObjectInstance> objects(inputs.size());
-
-	addInputs(objects, inputs);
-	const InstanceClassification& results = reasoner->run(request.threshold);
-	sendOutputs(results, response);
+	engine->classify(request, response);
 	clock_t end = clock();
 	double elapsed_ms = 1000 * double(end - begin) / CLOCKS_PER_SEC;
 	ROS_DEBUG_STREAM("Service takes: " << elapsed_ms << "ms");
 
+	ClassificationCache* cache = engine->getCache();
+	if (cache)
+	{
+		ROS_DEBUG_STREAM(
+					"Cache hits: " << cache->getHits() << ", misses: " << cache->getMisses());
+	}
+
+	return true;
+}
+
+bool ClassifierServiceHandler::batchClassificationCallback(
+			BatchClassification::Request& request,
+			BatchClassification::Response& response)
+{
+	ROS_DEBUG_STREAM(
+				"Number of groups to classify: " << request.groups.size());
+	clock_t begin = clock();
+	engine->classify(request, response);
+	clock_t end = clock();
+	double elapsed_ms = 1000 * double(end - begin) / CLOCKS_PER_SEC;
+	ROS_DEBUG_STREAM("Batch service takes: " << elapsed_ms << "ms");
+
+	return true;
+}
+
+bool ClassifierServiceHandler::compactClassificationCallback(
+			CompactClassification::Request& request,
+			CompactClassification::Response& response)
+{
+	//the columns and class indices would be bound to the wrong names
+	if (request.schemaVersion != engine->getSchemaVersion())
+	{
+		ROS_WARN("Compact request packed with an old schema, rejected");
+		return false;
+	}
+
+	ROS_DEBUG_STREAM(
+				"Number of compact groups to classify: " << request.groups.size());
+	clock_t begin = clock();
+	engine->classify(request, response);
+	clock_t end = clock();
+	double elapsed_ms = 1000 * double(end - begin) / CLOCKS_PER_SEC;
+	ROS_DEBUG_STREAM("Compact service takes: " << elapsed_ms << "ms");
+
+	return true;
+}
+
+bool ClassifierServiceHandler::schemaRequestCallback(
+			ClassificationSchema::Request& request,
+			ClassificationSchema::Response& response)
+{
+	engine->getSchema(response);
 	return true;
 }
 
@@ -87,7 +137,7 @@ bool ClassifierServiceHandler::reasoningGraphRequestCallback(
 			c_fuzzy::Graph::Response& response)
 {
 	stringstream ss;
-	classifier->drawReasoningGraph(ss);
+	engine->drawReasoningGraph(ss);
 	response.graph = ss.str();
 	return true;
 }
@@ -97,55 +147,22 @@ bool ClassifierServiceHandler::dependencyGraphRequestCallback(
 			c_fuzzy::Graph::Response& response)
 {
 	stringstream ss;
-	classifier->drawDependencyGraph(ss);
+	engine->drawDependencyGraph(ss);
 	response.graph = ss.str();
 	return true;
 }
 
-ClassifierServiceHandler::~ClassifierServiceHandler()
-{
-	delete reasoner;
-	delete classifier;
-	delete knowledgeBase;
-}
-
-void ClassifierServiceHandler::addInputs(vector<ObjectInstance>& objects,
-			vector<InputObject>& inputs)
+bool ClassifierServiceHandler::reasoningPlanRequestCallback(
+			c_fuzzy::Graph::Request& request,
+			c_fuzzy::Graph::Response& response)
 {
-	for (size_t i = 0; i < inputs.size(); i++)
-	{
-		InputObject& input = inputs[i];
-		ObjectInstance& instance = objects[i];
-		instance.id = input.id;
-		vector<InputVariable>& map = input.variables;
-		for (auto& inputVariable : map)
-		{
-			instance.properties[inputVariable.name] = inputVariable.value;
-		}
-
-		reasoner->addInstance(&instance);
-	}
+	stringstream ss;
+	engine->drawPlan(ss);
+	response.graph = ss.str();
+	return true;
 }
 
-void ClassifierServiceHandler::sendOutputs(
-			const InstanceClassification& results,
-			Classification::Response& response)
+ClassifierServiceHandler::~ClassifierServiceHandler()
 {
-	for (InstanceClassification::const_iterator it = results.begin();
-				it != results.end(); ++it)
-	{
-		response.results.push_back(ObjectClassification());
-		ObjectClassification& classification = response.results.back();
-		classification.id = it->first;
-		const ClassificationMap& map = it->second;
-		for (ClassificationMap::const_iterator j = map.begin(); j != map.end();
-					j++)
-		{
-			classification.classifications.push_back(ClassificationOutput());
-			ClassificationOutput& out = classification.classifications.back();
-			out.className = j->first;
-			out.membership = j->second;
-		}
-	}
+	delete engine;
 }
-
@@ -37,7 +37,9 @@ CommandLineParser::CommandLineParser() :
 	("reasoner,r", value<string>(), "set up a reasoner from knowledgebase") //
 	("classifier,c", value<vector<string> >()->multitoken(), "set up a classifier from\n"
 				"\t- a classifier file\n"
-				"\t- a knowledgebase\n");
+				"\t- a knowledgebase\n") //
+	("cache", value<size_t>()->default_value(0), "size of the classification cache, 0 to disable it") //
+	("quantization", value<int>()->default_value(1), "quantization step of the cached variables");
 
 	reasoner = false;
 	classifier = false;
@@ -94,6 +96,16 @@ string CommandLineParser::getClassifierKnowledgeBase()
 	return vm["classifier"].as<vector<string> >()[0];
 }
 
+size_t CommandLineParser::getCacheSize()
+{
+	return vm["cache"].as<size_t>();
+}
+
+int CommandLineParser::getCacheQuantization()
+{
+	return vm["quantization"].as<int>();
+}
+
 bool CommandLineParser::hasReasoner()
 {
 	return reasoner;
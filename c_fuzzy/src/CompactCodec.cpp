@@ -0,0 +1,92 @@
+/*
+ * c_fuzzy,
+ *
+ *
+ * Copyright (C) 2014 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of c_fuzzy.
+ *
+ * c_fuzzy is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * c_fuzzy is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with c_fuzzy.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CompactCodec.h"
+
+using namespace std;
+using namespace c_fuzzy;
+
+CompactCodec::CompactCodec(const ClassificationSchema::Response& schema) :
+			classes(schema.classes), version(schema.version)
+{
+	for (size_t column = 0; column < schema.variables.size(); column++)
+	{
+		columns[schema.variables[column]] = column;
+	}
+}
+
+void CompactCodec::encode(double threshold, uint32_t topK,
+			const vector<InputObject>& objects, CompactGroup& group)
+{
+	group.threshold = threshold;
+	group.topK = topK;
+	group.objects.resize(objects.size());
+
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		const InputObject& input = objects[i];
+		CompactObject& object = group.objects[i];
+		object.id = input.id;
+
+		for (auto& variable : input.variables)
+		{
+			//variables not used by any class are not sent
+			map<string, uint16_t>::iterator it = columns.find(variable.name);
+			if (it != columns.end())
+			{
+				object.columns.push_back(it->second);
+				object.values.push_back(variable.value);
+			}
+		}
+	}
+}
+
+bool CompactCodec::decode(const CompactGroupOutput& output,
+			vector<ObjectClassification>& results)
+{
+	results.resize(output.results.size());
+
+	for (size_t i = 0; i < output.results.size(); i++)
+	{
+		const CompactOutput& compact = output.results[i];
+		ObjectClassification& result = results[i];
+		result.id = compact.id;
+		result.classifications.resize(compact.classes.size());
+
+		if (compact.memberships.size() != compact.classes.size())
+			return false;
+
+		for (size_t k = 0; k < compact.classes.size(); k++)
+		{
+			//an unknown class means the schema is stale
+			if (compact.classes[k] >= classes.size())
+				return false;
+
+			ClassificationOutput& out = result.classifications[k];
+			out.className = classes[compact.classes[k]];
+			out.membership = compact.memberships[k];
+		}
+	}
+
+	return true;
+}
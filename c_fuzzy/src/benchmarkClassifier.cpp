@@ -0,0 +1,292 @@
+/*
+ * c_fuzzy,
+ *
+ *
+ * Copyright (C) 2014 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of c_fuzzy.
+ *
+ * c_fuzzy is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * c_fuzzy is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with c_fuzzy.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <cstdlib>
+#include <new>
+
+#include "FuzzyBuilder.h"
+#include "TreeClassifierBuilder.h"
+#include "ClassifierReasoner.h"
+
+using namespace std;
+
+//allocation counter
+static atomic<size_t> allocations(0);
+
+void* operator new(size_t size)
+{
+	allocations++;
+	void* p = malloc(size);
+	if (!p)
+		throw bad_alloc();
+	return p;
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+//scene generation parameters, close to the recognizer output on 640x480 frames
+static const int IMAGE_WIDTH = 640;
+static const int IMAGE_HEIGHT = 480;
+static const int FRAMES = 20;
+static const double THRESHOLD = 0.5;
+
+class SceneGenerator
+{
+public:
+	SceneGenerator(unsigned int seed) :
+				generator(seed)
+	{
+	}
+
+	void addRectangle(ClassifierReasoner& reasoner, size_t id)
+	{
+		int width = uniform(20, 300);
+		int height = uniform(20, 400);
+		int xMin = uniform(0, IMAGE_WIDTH - width);
+		int yMin = uniform(0, IMAGE_HEIGHT - height);
+
+		size_t row = reasoner.addInstance(id);
+		reasoner.setProperty(row, "xMin", xMin);
+		reasoner.setProperty(row, "xMax", xMin + width);
+		reasoner.setProperty(row, "yMin", yMin);
+		reasoner.setProperty(row, "yMax", yMin + height);
+		reasoner.setProperty(row, "formFactor", 1000 * width / height);
+		reasoner.setProperty(row, "area", width * height);
+	}
+
+	void addPole(ClassifierReasoner& reasoner, size_t id)
+	{
+		int deltaX = uniform(1, 10);
+		int deltaY = uniform(50, 400);
+
+		size_t row = reasoner.addInstance(id);
+		reasoner.setProperty(row, "height", deltaY);
+		reasoner.setProperty(row, "formFactor", 1000 * deltaY / deltaX);
+	}
+
+	void addCluster(ClassifierReasoner& reasoner, size_t id)
+	{
+		size_t row = reasoner.addInstance(id);
+		reasoner.setProperty(row, "x", uniform(0, IMAGE_WIDTH));
+		reasoner.setProperty(row, "y", uniform(0, IMAGE_HEIGHT));
+		reasoner.setProperty(row, "size", uniform(5, 50));
+	}
+
+	//n rectangles, n/4 poles and n/2 clusters
+	void addScene(ClassifierReasoner& reasoner, size_t n)
+	{
+		size_t id = 0;
+
+		for (size_t i = 0; i < n; i++)
+			addRectangle(reasoner, id++);
+
+		for (size_t i = 0; i < n / 4; i++)
+			addPole(reasoner, id++);
+
+		for (size_t i = 0; i < n / 2; i++)
+			addCluster(reasoner, id++);
+	}
+
+private:
+	int uniform(int min, int max)
+	{
+		uniform_int_distribution<int> distribution(min, max);
+		return distribution(generator);
+	}
+
+private:
+	mt19937 generator;
+};
+
+void writeHierarchy(const string& kbPath, const string& classifierPath,
+			size_t depth)
+{
+	ofstream kb(kbPath.c_str());
+	ofstream classifier(classifierPath.c_str());
+
+	kb << "FUZZIFY_CLASS Rectangle" << endl;
+	kb << "\tFUZZIFY formFactor" << endl;
+	kb << "\t\tAny := tra(0, 100, 5000, 6000);" << endl;
+	kb << "\tEND_FUZZIFY" << endl;
+	kb << "\tFUZZIFY area" << endl;
+	kb << "\t\tBig := tor(1000, 5000);" << endl;
+	kb << "\tEND_FUZZIFY" << endl;
+	kb << "END_FUZZIFY_CLASS" << endl;
+	kb << "FUZZIFY_CLASS Cluster" << endl;
+	kb << "END_FUZZIFY_CLASS" << endl;
+
+	classifier << "CLASS Rectangle HIDDEN" << endl;
+	classifier << "\tVARIABLES" << endl;
+	classifier << "\t\txMin; xMax; yMin; yMax; formFactor; area;" << endl;
+	classifier << "\tEND_VARIABLES" << endl;
+	classifier << "END_CLASS" << endl;
+	classifier << "CLASS Cluster HIDDEN" << endl;
+	classifier << "\tVARIABLES" << endl;
+	classifier << "\t\tx; y;" << endl;
+	classifier << "\tEND_VARIABLES" << endl;
+	classifier << "END_CLASS" << endl;
+
+	//a chain of subclasses, each with a related cluster class
+	for (size_t level = 1; level <= depth; level++)
+	{
+		stringstream name, superName, marker;
+		name << "Level" << level;
+		marker << "Marker" << level;
+		if (level == 1)
+			superName << "Rectangle";
+		else
+			superName << "Level" << level - 1;
+
+		kb << "FUZZIFY_CLASS " << name.str() << endl;
+		kb << "END_FUZZIFY_CLASS" << endl;
+		kb << "FUZZIFY_CLASS " << marker.str() << endl;
+		kb << "\tFUZZIFY_PREDICATE ?x" << endl;
+		kb << "\t\tInside := (?x is Inside);" << endl;
+		kb << "\t\tFUZZIFY ?x" << endl;
+		kb << "\t\t\tInside := tra(0, 10, 90, 100);" << endl;
+		kb << "\t\tEND_FUZZIFY" << endl;
+		kb << "\tEND_FUZZIFY_PREDICATE" << endl;
+		kb << "END_FUZZIFY_CLASS" << endl;
+
+		classifier << "CLASS " << name.str() << " extends " << superName.str()
+					<< endl;
+		classifier << "\t" << ((level % 2) ? "area is Big;" : "formFactor is Any;")
+					<< endl;
+		classifier << "END_CLASS" << endl;
+		classifier << "CLASS " << marker.str() << " extends Cluster" << endl;
+		classifier << "\tx is Inside on " << name.str() << "(xMin, xMax);"
+					<< endl;
+		classifier << "\ty is Inside on " << name.str() << "(yMin, yMax);"
+					<< endl;
+		classifier << "END_CLASS" << endl;
+	}
+}
+
+void runBenchmark(const string& name, const string& kbPath,
+			const string& classifierPath, size_t maxObjects)
+{
+	FuzzyBuilder kbBuilder;
+	TreeClassifierBuilder classifierBuilder;
+
+	kbBuilder.parse(kbPath.c_str());
+	FuzzyKnowledgeBase* knowledgeBase = kbBuilder.createKnowledgeBase();
+	classifierBuilder.parse(classifierPath.c_str());
+	FuzzyClassifier* classifier = classifierBuilder.buildFuzzyClassifier();
+
+	ClassifierReasoner* reasoner = new ClassifierReasoner(*classifier,
+				*knowledgeBase);
+
+	cout << name << endl;
+	cout << setw(10) << "rects" << setw(10) << "objects" << setw(14)
+				<< "ms/frame" << setw(16) << "combinations" << setw(14)
+				<< "evaluations" << setw(10) << "pruned" << setw(14)
+				<< "allocations" << endl;
+
+	for (size_t n = 5; n <= maxObjects; n *= 2)
+	{
+		SceneGenerator generator(n);
+		reasoner->resetStats();
+		double elapsed = 0;
+		size_t allocated = 0;
+
+		for (int frame = 0; frame < FRAMES; frame++)
+		{
+			//only the classification is measured
+			generator.addScene(*reasoner, n);
+
+			size_t startAllocations = allocations;
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+			reasoner->run(THRESHOLD);
+
+			chrono::steady_clock::time_point end = chrono::steady_clock::now();
+			elapsed += chrono::duration<double, milli>(end - start).count();
+			allocated += allocations - startAllocations;
+		}
+
+		const ReasonerStats& stats = reasoner->getStats();
+		cout << setw(10) << n << setw(10) << n + n / 4 + n / 2 << setw(14)
+					<< elapsed / FRAMES << setw(16) << stats.combinations / FRAMES
+					<< setw(14) << stats.evaluations / FRAMES << setw(10)
+					<< stats.pruned / FRAMES << setw(14) << allocated / FRAMES
+					<< endl;
+	}
+
+	cout << endl;
+
+	delete reasoner;
+	delete classifier;
+	delete knowledgeBase;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3)
+	{
+		cout << "Usage: " << argv[0]
+					<< " <knowledgebase> <classifier> [max rectangles]" << endl;
+		return -1;
+	}
+
+	size_t maxObjects = (argc > 3) ? atoi(argv[3]) : 160;
+
+	try
+	{
+		runBenchmark(argv[2], argv[1], argv[2], maxObjects);
+
+		size_t depths[] = { 2, 4, 8 };
+		for (auto depth : depths)
+		{
+			stringstream kbPath, classifierPath, name;
+			kbPath << "/tmp/benchmark_hierarchy_" << depth << ".kb";
+			classifierPath << "/tmp/benchmark_hierarchy_" << depth << ".fuzzy";
+			name << "synthetic hierarchy, depth " << depth;
+
+			writeHierarchy(kbPath.str(), classifierPath.str(), depth);
+			runBenchmark(name.str(), kbPath.str(), classifierPath.str(),
+						maxObjects);
+		}
+	}
+	catch (const std::runtime_error& e)
+	{
+		cout << e.what() << endl;
+		cout << "Check the input file an try again" << endl;
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * c_fuzzy,
+ *
+ *
+ * Copyright (C) 2014 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of c_fuzzy.
+ *
+ * c_fuzzy is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * c_fuzzy is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with c_fuzzy.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ClassificationCache.h"
+
+using namespace std;
+
+size_t ClassificationCache::KeyHash::operator()(const Key& key) const
+{
+	size_t seed = key.size();
+
+	for (auto value : key)
+	{
+		seed ^= hash<int>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	}
+
+	return seed;
+}
+
+ClassificationCache::ClassificationCache(size_t capacity) :
+			capacity(capacity)
+{
+	hits = 0;
+	misses = 0;
+}
+
+bool ClassificationCache::lookup(const Key& key, double& truth)
+{
+	CacheMap::iterator it = cacheMap.find(key);
+
+	if (it == cacheMap.end())
+	{
+		misses++;
+		return false;
+	}
+
+	//move the entry in front of the list
+	lruList.splice(lruList.begin(), lruList, it->second);
+	truth = it->second->second;
+	hits++;
+
+	return true;
+}
+
+void ClassificationCache::insert(const Key& key, double truth)
+{
+	if (capacity == 0)
+		return;
+
+	CacheMap::iterator it = cacheMap.find(key);
+
+	if (it != cacheMap.end())
+	{
+		it->second->second = truth;
+		lruList.splice(lruList.begin(), lruList, it->second);
+		return;
+	}
+
+	if (lruList.size() >= capacity)
+	{
+		cacheMap.erase(lruList.back().first);
+		lruList.pop_back();
+	}
+
+	lruList.push_front(CacheEntry(key, truth));
+	cacheMap[key] = lruList.begin();
+}
+
+void ClassificationCache::clear()
+{
+	lruList.clear();
+	cacheMap.clear();
+	hits = 0;
+	misses = 0;
+}
+
+size_t ClassificationCache::size()
+{
+	return lruList.size();
+}
+
+size_t ClassificationCache::getHits()
+{
+	return hits;
+}
+
+size_t ClassificationCache::getMisses()
+{
+	return misses;
+}
@@ -25,34 +25,108 @@
 
 #include "RuleBuilder.h"
 
+#include <algorithm>
+
 using namespace std;
 
 ClassifierReasoner::ClassifierReasoner(FuzzyClassifier& classifier,
 			FuzzyKnowledgeBase& knowledgeBase) :
-			classifier(classifier), knowledgeBase(knowledgeBase)
+			classifier(classifier), knowledgeBase(knowledgeBase),
+			instances(classifier.getSchema())
 {
+	const InstanceSchema& schema = classifier.getSchema();
+	int classIndex = 0;
+
 	for (auto& i : classifier)
 	{
 		string className = i.first;
 		FuzzyClass& fuzzyClass = *i.second;
-		RuleBuilder builder(knowledgeBase);
+		RuleBuilder builder(knowledgeBase, schema);
 		genVarTable[className] = builder.buildClassRule(fuzzyClass);
+		classIndices[className] = classIndex++;
+		classStats[className] = ClassStatistics();
+
+		//resolve the class variables to table columns once
+		ClassInputs& inputs = classInputs[className];
+		for (auto& variable : fuzzyClass.getVars())
+		{
+			size_t column = schema.getColumn(variable);
+			inputs.push_back(make_pair(column, Variable(className, variable)));
+		}
+	}
+
+	//top-k pruning is safe only if no relation uses the class or a subclass
+	for (auto& i : classifier)
+	{
+		if (i.second->isHidden())
+			hiddenClasses.insert(i.first);
+		prunableClasses.insert(i.first);
+	}
+
+	for (auto& i : classifier)
+	{
+		for (auto& dependency : classifier.getDependenciesNames(i.second))
+		{
+			for (FuzzyClass* c = classifier.getClass(dependency); c != NULL;
+						c = c->getSuperClass())
+				prunableClasses.erase(c->getName());
+		}
 	}
 
 	reasoner = new FuzzyReasoner(knowledgeBase);
 	threshold = 1.0;
 
+	cache = NULL;
+	quantization = 1;
+	useCache = false;
+	levelColumns.resize(classIndex);
+}
+
+size_t ClassifierReasoner::addInstance(size_t id)
+{
+	return instances.addRow(id);
+}
+
+void ClassifierReasoner::setProperty(size_t row, const string& name,
+			int value)
+{
+	const InstanceSchema& schema = instances.getSchema();
+
+	//variables not used by any class are ignored
+	if (schema.contains(name))
+		instances.setValue(row, schema.getColumn(name), value);
+}
+
+void ClassifierReasoner::setProperty(size_t row, size_t column, int value)
+{
+	instances.setValue(row, column, value);
+}
+
+const InstanceSchema& ClassifierReasoner::getSchema()
+{
+	return instances.getSchema();
+}
+
+void ClassifierReasoner::setCache(size_t capacity, int quantization)
+{
+	delete cache;
+	cache = (capacity > 0) ? new ClassificationCache(capacity) : NULL;
+	this->quantization = max(quantization, 1);
 }
 
-void ClassifierReasoner::addInstance(ObjectInstance* instance)
+ClassificationCache* ClassifierReasoner::getCache()
 {
-	inputs.insert(instance);
+	return cache;
 }
 
-InstanceClassification ClassifierReasoner::run(double threshold)
+InstanceClassification ClassifierReasoner::run(double threshold,
+			bool bypassCache, size_t topK)
 {
 	setThreshold(threshold);
+	useCache = cache && !bypassCache;
+	setupTables();
 	InstanceClassification results;
+	lastPlan.clear();
 
 	for (ReasoningList::iterator i = classifier.beginReasoning();
 				i != classifier.endReasoning(); ++i)
@@ -62,28 +136,101 @@ InstanceClassification ClassifierReasoner::run(double threshold)
 		DepLists dependencies;
 
 		getCandidates(classList, candidates, dependencies);
-		classify(classList, dependencies, candidates, results);
+		if (topK > 0)
+			pruneTopK(classList, candidates, results, topK);
+
+		ClassPlan plan;
+		planComponent(classList, candidates, dependencies, plan);
+		classify(plan, dependencies, candidates, results);
 	}
 
+	updateStatistics();
 	table.clear();
-	inputs.clear();
+	instances.clear();
+	inputMask.clear();
 
 	deleteHidden(results);
+	if (topK > 0)
+		keepBest(results, topK);
 
 	return results;
 }
 
+const ReasonerStats& ClassifierReasoner::getStats()
+{
+	return stats;
+}
+
+void ClassifierReasoner::resetStats()
+{
+	stats = ReasonerStats();
+}
+
+void ClassifierReasoner::drawPlan(ostream& stream)
+{
+	stream << "digraph G {" << endl;
+
+	for (size_t i = 0; i < lastPlan.size(); i++)
+	{
+		ComponentPlan& plan = lastPlan[i];
+		stream << "subgraph cluster_" << i << " {" << endl;
+		stream << "label=\"component " << i << "\";" << endl;
+
+		for (size_t j = 0; j < plan.size(); j++)
+		{
+			PlanStep& step = plan[j];
+			stream << "\"" << step.className << "\" [label=\"" << j + 1 << ". "
+						<< step.className << "\\ncandidates: " << step.candidates
+						<< "\\nselectivity: " << step.selectivity;
+
+			if (!step.dependencies.empty())
+			{
+				stream << "\\ndependencies:";
+				for (auto& dependency : step.dependencies)
+					stream << " " << dependency;
+			}
+
+			stream << "\"];" << endl;
+
+			if (j > 0)
+				stream << "\"" << plan[j - 1].className << "\" -> \""
+							<< step.className << "\";" << endl;
+		}
+
+		stream << "}" << endl;
+	}
+
+	stream << "}" << endl;
+}
+
 void ClassifierReasoner::setThreshold(double thr)
 {
 	threshold = min(max(thr, 0.0), 1.0);
 }
 
+void ClassifierReasoner::setupTables()
+{
+	inputMask.resize(instances.size());
+	inputMask.set();
+
+	for (auto& i : classifier)
+	{
+		table[i.first].resize(instances.size());
+	}
+
+	//no instance belongs to any class yet
+	for (auto& column : levelColumns)
+	{
+		column.assign(instances.size(), 0.0);
+	}
+}
+
 void ClassifierReasoner::getCandidates(ClassList& classList,
 			ObjectListMap& candidates, DepLists& deps)
 {
 	for (auto& it : classList)
 	{
-		string className = it.first;
+		const string& className = it.first;
 		FuzzyClass* fuzzyClass = it.second;
 		getClassCandidates(fuzzyClass, candidates[className]);
 		deps[className] = classifier.getDependenciesNames(fuzzyClass);
@@ -94,12 +241,12 @@ void ClassifierReasoner::getCandidates(ClassList& classList,
 void ClassifierReasoner::getClassCandidates(FuzzyClass* fuzzyClass,
 			ObjectList& candidates)
 {
-	ObjectList& list = getSuperClassCandidates(fuzzyClass);
+	candidates = getSuperClassCandidates(fuzzyClass);
 
-	for (auto& instance : list)
+	//keep only the instances having all the class variables
+	for (auto& input : classInputs[fuzzyClass->getName()])
 	{
-		if (hasClassVariables(*instance, *fuzzyClass))
-			candidates.insert(instance);
+		candidates &= instances.getPresence(input.first);
 	}
 }
 
@@ -112,32 +259,111 @@ ObjectList& ClassifierReasoner::getSuperClassCandidates(FuzzyClass* fuzzyClass)
 	}
 	else
 	{
-		return inputs;
+		return inputMask;
 	}
 }
 
-bool ClassifierReasoner::hasClassVariables(ObjectInstance& instance,
-			FuzzyClass& fuzzyClass)
+void ClassifierReasoner::planComponent(ClassList& classList,
+			ObjectListMap& candidates, DepLists& deps, ClassPlan& plan)
 {
-	const VariableList& variables = fuzzyClass.getVars();
-	for (VariableList::const_iterator it = variables.begin();
-				it != variables.end(); ++it)
+	plan.assign(classList.begin(), classList.end());
+
+	//the results of deferred classes depend on the visiting order
+	bool ordered = true;
+	for (auto& it : classList)
 	{
-		if (instance.properties.count(*it) == 0)
+		FuzzyClass* superClass = it.second->getSuperClass();
+		if (superClass && candidates.count(superClass->getName()) != 0)
+			ordered = false;
+	}
+
+	if (ordered)
+	{
+		//cheapest classes first, so that the bound prunes as early as possible
+		stable_sort(plan.begin(), plan.end(),
+					[&](const ClassPlan::value_type& a,
+								const ClassPlan::value_type& b)
+					{
+						return getCost(a.first, candidates)
+									< getCost(b.first, candidates);
+					});
+
+		for (auto& it : plan)
 		{
-			return false;
+			const string& className = it.first;
+			DepList& dependencies = deps[className];
+			stable_sort(dependencies.begin(), dependencies.end(),
+						[&](const string& a, const string& b)
+						{
+							return getDependencySize(className, a, candidates)
+										< getDependencySize(className, b, candidates);
+						});
 		}
 	}
 
-	return true;
+	ComponentPlan componentPlan;
+	for (auto& it : plan)
+	{
+		PlanStep step;
+		step.className = it.first;
+		step.candidates = candidates[it.first].count();
+		step.selectivity = classStats[it.first].selectivity;
+		step.dependencies = deps[it.first];
+		componentPlan.push_back(step);
+	}
+
+	lastPlan.push_back(componentPlan);
+}
+
+double ClassifierReasoner::getCost(const string& className,
+			ObjectListMap& candidates)
+{
+	//expected number of bindings surviving the class
+	return candidates[className].count() * classStats[className].selectivity;
+}
+
+size_t ClassifierReasoner::getDependencySize(const string& className,
+			const string& dependencyName, ObjectListMap& candidates)
+{
+	if (className == dependencyName)
+		return candidates[dependencyName].count();
+	else if (candidates.count(dependencyName) != 0)
+		return 0; //bound by the component loop, not by this dependency
+	else
+		return table[dependencyName].count();
+}
+
+void ClassifierReasoner::updateStatistics()
+{
+	for (auto& it : classStats)
+	{
+		ClassStatistics& statistics = it.second;
+		if (statistics.evaluations > 0)
+		{
+			double rate = static_cast<double>(statistics.accepted)
+						/ statistics.evaluations;
+			statistics.selectivity = SELECTIVITY_DECAY * rate
+						+ (1 - SELECTIVITY_DECAY) * statistics.selectivity;
+			statistics.evaluations = 0;
+			statistics.accepted = 0;
+		}
+	}
 }
 
-void ClassifierReasoner::classify(ClassList& classList, DepLists& deps,
+void ClassifierReasoner::classify(ClassPlan& plan, DepLists& deps,
 			ObjectListMap& candidates, InstanceClassification& results)
 {
-	ClassificationData data(candidates, results);
-	ClassList::iterator begin = classList.begin();
-	ClassList::iterator end = classList.end();
+	ClassificationData data(instances, candidates, results);
+	ClassPlan::iterator begin = plan.begin();
+	ClassPlan::iterator end = plan.end();
+
+	//classes whose superclass is in this component are bounded at the end
+	for (auto& it : plan)
+	{
+		FuzzyClass* superClass = it.second->getSuperClass();
+		if (superClass && candidates.count(superClass->getName()) != 0)
+			data.deferred.insert(it.first);
+	}
 
 	if (begin != end && begin->second->isTrivial())
 		trivialClassify(begin, data);
@@ -145,43 +371,52 @@ void ClassifierReasoner::classify(ClassList& classList, DepLists& deps,
 		recursiveClassify(begin, end, deps, data);
 }
 
-void ClassifierReasoner::trivialClassify(ClassList::iterator current,
+void ClassifierReasoner::trivialClassify(ClassPlan::iterator current,
 			ClassificationData& data)
 {
-	string className = current->first;
-	FuzzyClass* fuzzyClass = current->second;
-	ObjectList candidates = data.candidates[className];
+	const string& className = current->first;
+	FuzzyClass* superClass = current->second->getSuperClass();
+	ObjectList& candidates = data.candidates[className];
+
+	//a trivial class takes the level of its superclass, column to column
+	vector<double>& levels = levelColumns[classIndices[className]];
+	const double* superLevels = NULL;
+	if (superClass)
+		superLevels = levelColumns[classIndices[superClass->getName()]].data();
 
-	for (auto& instance : candidates)
+	for (size_t i = candidates.find_first(); i != ObjectList::npos;
+				i = candidates.find_next(i))
 	{
-		ClassificationMap& instanceClassifications = data.results[instance->id];
-		instanceClassifications[className] = getMembershipLevel(instance->id,
-					fuzzyClass, 1.0, data);
-		table[className].insert(instance);
+		levels[i] = superLevels ? min(1.0, superLevels[i]) : 1.0;
+		data.results[instances.getId(i)][className] = levels[i];
 	}
 
+	table[className] |= candidates;
+
 }
 
-inline void ClassifierReasoner::recursiveClassify(ClassList::iterator current,
-			ClassList::iterator end, DepLists& deps, ClassificationData& data)
+inline void ClassifierReasoner::recursiveClassify(ClassPlan::iterator current,
+			ClassPlan::iterator end, DepLists& deps, ClassificationData& data)
 {
 
 	if (current != end)
 	{
-		string currentClass = current->first;
+		const string& currentClass = current->first;
 		ObjectList& candidate = data.candidates[currentClass];
+		DepList& instanceDependencies = deps[currentClass];
 
-		for (auto& instance : candidate)
+		for (size_t i = candidate.find_first(); i != ObjectList::npos;
+					i = candidate.find_next(i))
 		{
-			if (hasBeenConsidered(instance, data))
+			if (hasBeenConsidered(i, data))
 				continue;
-			data.instanceMap[currentClass] = instance;
-			DepList& instanceDependencies = deps[currentClass];
+			data.instanceMap[currentClass] = i;
 			recursiveClassify(current, end, instanceDependencies.begin(),
 						instanceDependencies.end(), deps, data);
-			noMoreConsidered(instance, data);
+			noMoreConsidered(i, data);
 		}
 
+		data.instanceMap.erase(currentClass);
 	}
 	else
 	{
@@ -189,13 +424,13 @@ inline void ClassifierReasoner::recursiveClassify(ClassList::iterator current,
 	}
 }
 
-inline void ClassifierReasoner::recursiveClassify(ClassList::iterator current,
-			ClassList::iterator end, DepList::iterator currentDep,
+inline void ClassifierReasoner::recursiveClassify(ClassPlan::iterator current,
+			ClassPlan::iterator end, DepList::iterator currentDep,
 			DepList::iterator endDep, DepLists& deps, ClassificationData& data)
 {
 	if (currentDep != endDep)
 	{
-		string dependencyName = *currentDep;
+		const string& dependencyName = *currentDep;
 		currentDep++;
 
 		//TODO si può risolvere meglio ragionando a livello di grafo dipendenze?
@@ -206,15 +441,40 @@ inline void ClassifierReasoner::recursiveClassify(ClassList::iterator current,
 			ObjectList& dependencyObjects = getDependencyObjects(current->first,
 						dependencyName, data);
 
-			for (auto& instance : dependencyObjects)
+			//last dependency, compute the class relations for all the objects
+			VariableGenerator* generator = genVarTable[current->first];
+			size_t stride = generator->getGeneratedVariables().size();
+
+			//one buffer per nesting level, reused across frames
+			size_t depth = data.batchDepth;
+			if (batchBuffers.size() <= depth)
+				batchBuffers.resize(depth + 1);
+
+			bool batched = currentDep == endDep
+						&& prepareBatch(current->first, dependencyName,
+									dependencyObjects, deps, batchBuffers[depth],
+									data);
+			size_t k = 0;
+
+			for (size_t i = dependencyObjects.find_first();
+						i != ObjectList::npos; i = dependencyObjects.find_next(i))
 			{
-				if (hasBeenConsidered(instance, data))
+				if (hasBeenConsidered(i, data))
 					continue;
-				data.dependencyMap[dependencyName] = instance;
+				if (batched)
+				{
+					data.batchClass = &current->first;
+					data.batchValues = batchBuffers[depth].data() + stride * k++;
+				}
+				data.dependencyMap[dependencyName] = i;
+				data.batchDepth++;
 				recursiveClassify(current, end, currentDep, endDep, deps, data);
-				noMoreConsidered(instance, data);
+				data.batchDepth--;
+				noMoreConsidered(i, data);
 			}
 
+			data.batchClass = NULL;
+			data.batchValues = NULL;
 			data.dependencyMap.erase(dependencyName);
 		}
 		else
@@ -224,29 +484,46 @@ inline void ClassifierReasoner::recursiveClassify(ClassList::iterator current,
 	}
 	else
 	{
-		recursiveClassify(++current, end, deps, data);
+		//the truth value can only decrease, prune if the bound is too low
+		double bound = data.bound;
+		const string* batchClass = data.batchClass;
+		const int* batchValues = data.batchValues;
+		DepList closed;
+
+		evaluateClosedClasses(deps, data, closed);
+		data.batchClass = NULL;
+		data.batchValues = NULL;
+
+		if (data.bound > 0 && data.bound >= threshold)
+			recursiveClassify(++current, end, deps, data);
+		else
+			stats.pruned++;
+
+		for (auto& className : closed)
+			data.levels.erase(className);
+
+		data.bound = bound;
+		data.batchClass = batchClass;
+		data.batchValues = batchValues;
 	}
 }
 
 inline void ClassifierReasoner::classifyInstances(ClassificationData& data)
 {
-	setupReasoning(data);
-	runReasoning(data);
-}
+	double truthValue = data.bound;
+	stats.combinations++;
 
-void ClassifierReasoner::setupReasoning(ClassificationData& data)
-{
 	for (auto& it : data.instanceMap)
 	{
-		string className = it.first;
-		ObjectInstance* instance = it.second;
-		ObjectProperties& properties = instance->properties;
-		reasoner->addInput(className, properties);
-		VariableGenerator* generator = genVarTable[className];
-		ObjectProperties genProperties = generator->getGeneratedProperties(
-					data.instanceMap, data.dependencyMap);
-		reasoner->addInput(className, genProperties);
+		const string& className = it.first;
+		if (data.levels.count(className) == 0)
+		{
+			double level = evaluateClass(className, it.second, data);
+			truthValue = min(truthValue, level);
+		}
 	}
+
+	setResults(truthValue, data);
 }
 
 ObjectList& ClassifierReasoner::getDependencyObjects(const string& className,
@@ -262,48 +539,169 @@ ObjectList& ClassifierReasoner::getDependencyObjects(const string& className,
 	}
 }
 
-void ClassifierReasoner::runReasoning(ClassificationData& data)
+void ClassifierReasoner::setResults(double truthValue,
+			ClassificationData& data)
 {
-	OutputTable result = reasoner->run();
-
-	double truthValue = getMinTruthValue(result, data);
-
 	if (truthValue > 0 && truthValue >= threshold)
 	{
 
 		for (auto& i : data.instanceMap)
 		{
 			const string& className = i.first;
-			ObjectInstance* instance = i.second;
+			size_t row = i.second;
 			ClassificationMap& instanceClassifications =
-						data.results[instance->id];
+						data.results[instances.getId(row)];
 
 			if (instanceClassifications.count(className) == 0
 						|| instanceClassifications[className] < truthValue)
 			{
 				instanceClassifications[className] = truthValue;
-				table[className].insert(instance);
+				levelColumns[classIndices[className]][row] = truthValue;
+				table[className].set(row);
 			}
 		}
 	}
 }
 
-double ClassifierReasoner::getMinTruthValue(OutputTable& result,
+void ClassifierReasoner::evaluateClosedClasses(DepLists& deps,
+			ClassificationData& data, DepList& closed)
+{
+	for (auto& it : data.instanceMap)
+	{
+		const string& className = it.first;
+		if (data.levels.count(className) == 0
+					&& isClosed(className, deps, data))
+		{
+			double level = evaluateClass(className, it.second, data);
+			data.levels[className] = level;
+			data.bound = min(data.bound, level);
+			closed.push_back(className);
+		}
+	}
+}
+
+bool ClassifierReasoner::isClosed(const string& className, DepLists& deps,
 			ClassificationData& data)
 {
-	double minValue = 1.0;
+	//superclass levels of this component may still grow
+	if (data.deferred.count(className) != 0)
+		return false;
 
-	for (auto& i : data.instanceMap)
+	for (auto& dependency : deps[className])
 	{
-		string className = i.first;
-		ObjectInstance* instance = i.second;
-		FuzzyClass* fuzzyClass = classifier.getClass(className);
-		double instanceLevel = getMembershipLevel(instance->id, fuzzyClass,
-					result[className][className].truth, data);
-		minValue = min(minValue, instanceLevel);
+		if (data.dependencyMap.count(dependency) == 0
+					&& data.instanceMap.count(dependency) == 0)
+			return false;
 	}
 
-	return minValue;
+	return true;
+}
+
+double ClassifierReasoner::evaluateClass(const string& className, size_t row,
+			ClassificationData& data)
+{
+	const vector<Variable>& generatedVariables =
+				genVarTable[className]->getGeneratedVariables();
+	const int* generated = getGeneratedValues(className, data);
+	size_t size = generatedVariables.size();
+
+	double truth;
+	if (!useCache || !lookupCache(className, row, generated, size, truth))
+	{
+		//class rules only read their own namespace, so they can run alone
+		for (auto& input : classInputs[className])
+		{
+			reasoner->addInput(input.second,
+						instances.getValue(row, input.first));
+		}
+
+		for (size_t i = 0; i < size; i++)
+		{
+			reasoner->addInput(generatedVariables[i], generated[i]);
+		}
+
+		OutputTable result = reasoner->run();
+		truth = result[className][className].truth;
+		stats.evaluations++;
+
+		if (useCache)
+			cache->insert(cacheKey, truth);
+	}
+
+	ClassStatistics& statistics = classStats[className];
+	statistics.evaluations++;
+	if (truth > 0 && truth >= threshold)
+		statistics.accepted++;
+
+	FuzzyClass* fuzzyClass = classifier.getClass(className);
+	return getMembershipLevel(instances.getId(row), fuzzyClass, truth, data);
+}
+
+bool ClassifierReasoner::prepareBatch(const string& className,
+			const string& dependencyName, ObjectList& objects, DepLists& deps,
+			vector<int>& values, ClassificationData& data)
+{
+	//the class must become closed as soon as the dependency is bound
+	if (data.deferred.count(className) != 0)
+		return false;
+
+	for (auto& dependency : deps[className])
+	{
+		if (dependency != dependencyName
+					&& data.dependencyMap.count(dependency) == 0
+					&& data.instanceMap.count(dependency) == 0)
+			return false;
+	}
+
+	batchRows.clear();
+	for (size_t i = objects.find_first(); i != ObjectList::npos;
+				i = objects.find_next(i))
+	{
+		if (!data.tabuList.test(i))
+			batchRows.push_back(i);
+	}
+
+	VariableGenerator* generator = genVarTable[className];
+	generator->getGeneratedValues(instances, data.instanceMap,
+				data.dependencyMap, dependencyName, batchRows, values);
+
+	return true;
+}
+
+const int* ClassifierReasoner::getGeneratedValues(const string& className,
+			ClassificationData& data)
+{
+	if (data.batchClass && *data.batchClass == className)
+		return data.batchValues;
+
+	VariableGenerator* generator = genVarTable[className];
+	generator->getGeneratedValues(instances, data.instanceMap,
+				data.dependencyMap, generatedValues);
+
+	return generatedValues.data();
+}
+
+bool ClassifierReasoner::lookupCache(const string& className, size_t row,
+			const int* generated, size_t size, double& truth)
+{
+	//the key is made of the class, its quantized inputs and the relations
+	cacheKey.clear();
+	cacheKey.push_back(classIndices[className]);
+
+	//floor division, so that the buckets around zero are not merged
+	for (auto& input : classInputs[className])
+	{
+		int value = instances.getValue(row, input.first);
+		int bucket = value / quantization;
+		if (value % quantization < 0)
+			bucket--;
+
+		cacheKey.push_back(bucket);
+	}
+
+	cacheKey.insert(cacheKey.end(), generated, generated + size);
+
+	return cache->lookup(cacheKey, truth);
 }
 
 double ClassifierReasoner::getMembershipLevel(size_t id, FuzzyClass* fuzzyClass,
@@ -322,6 +720,12 @@ double ClassifierReasoner::getMembershipLevel(size_t id, FuzzyClass* fuzzyClass,
 	}
 }
 
+ClassifierReasoner::~ClassifierReasoner()
+{
+	delete reasoner;
+	delete cache;
+}
+
 void ClassifierReasoner::deleteHidden(InstanceClassification& results)
 {
 	for (auto& i : results)
@@ -339,28 +743,84 @@ void ClassifierReasoner::deleteHidden(InstanceClassification& results)
 	}
 }
 
-bool ClassifierReasoner::hasBeenConsidered(ObjectInstance* instance,
+void ClassifierReasoner::pruneTopK(ClassList& classList,
+			ObjectListMap& candidates, InstanceClassification& results,
+			size_t topK)
+{
+	for (auto& it : classList)
+	{
+		const string& className = it.first;
+		FuzzyClass* superClass = it.second->getSuperClass();
+
+		if (!superClass || prunableClasses.count(className) == 0
+					|| classList.count(superClass->getName()) != 0)
+			continue;
+
+		//the class level is bounded by the superclass one
+		const string superName = superClass->getName();
+		ObjectList& classCandidates = candidates[className];
+		for (size_t i = classCandidates.find_first(); i != ObjectList::npos;
+					i = classCandidates.find_next(i))
+		{
+			ClassificationMap& classifications = results[instances.getId(i)];
+			ClassificationMap::iterator superIt = classifications.find(superName);
+			double superLevel =
+						(superIt != classifications.end()) ? superIt->second : 0;
+			size_t better = 0;
+
+			for (auto& c : classifications)
+			{
+				if (c.second > superLevel && hiddenClasses.count(c.first) == 0)
+					better++;
+			}
+
+			if (better >= topK)
+				classCandidates.reset(i);
+		}
+	}
+}
+
+void ClassifierReasoner::keepBest(InstanceClassification& results,
+			size_t topK)
+{
+	for (auto& i : results)
+	{
+		ClassificationMap& classifications = i.second;
+		if (classifications.size() <= topK)
+			continue;
+
+		vector<pair<double, string> > levels;
+		for (auto& c : classifications)
+			levels.push_back(make_pair(-c.second, c.first));
+
+		partial_sort(levels.begin(), levels.begin() + topK, levels.end());
+
+		classifications.clear();
+		for (size_t k = 0; k < topK; k++)
+			classifications[levels[k].second] = -levels[k].first;
+	}
+}
+
+bool ClassifierReasoner::hasBeenConsidered(size_t index,
 			ClassificationData& data)
 {
 	TabuList& tabuList = data.tabuList;
-	size_t id = instance->id;
-	if (tabuList.count(id) != 0)
+	if (tabuList.test(index))
 	{
 		return true;
 	}
 	else
 	{
-		tabuList.insert(id);
+		tabuList.set(index);
 		return false;
 	}
 
 }
 
-void ClassifierReasoner::noMoreConsidered(ObjectInstance* instance,
+void ClassifierReasoner::noMoreConsidered(size_t index,
 			ClassificationData& data)
 {
 	TabuList& tabuList = data.tabuList;
-	size_t id = instance->id;
-	tabuList.erase(id);
+	tabuList.reset(index);
 }
 
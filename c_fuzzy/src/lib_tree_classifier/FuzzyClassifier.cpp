@@ -40,6 +40,11 @@ void FuzzyClassifier::addClass(FuzzyClass* fuzzyClass)
 	classList[fuzzyClass->getName()] = fuzzyClass;
 
 	dGraph.addClass(fuzzyClass);
+
+	for (auto& variable : fuzzyClass->getVars())
+	{
+		schema.addVariable(variable);
+	}
 }
 
 void FuzzyClassifier::addDependency(std::string fuzzyClass,
@@ -101,6 +106,11 @@ ReasoningList::iterator FuzzyClassifier::endReasoning()
 	return reasoningList.end();
 }
 
+const InstanceSchema& FuzzyClassifier::getSchema()
+{
+	return schema;
+}
+
 void FuzzyClassifier::drawDependencyGraph(string path)
 {
 	ofstream out;
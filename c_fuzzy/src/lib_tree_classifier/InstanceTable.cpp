@@ -0,0 +1,110 @@
+/*
+ * c_fuzzy,
+ *
+ *
+ * Copyright (C) 2014 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of c_fuzzy.
+ *
+ * c_fuzzy is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * c_fuzzy is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with c_fuzzy.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "InstanceTable.h"
+
+#include <stdexcept>
+
+using namespace std;
+
+size_t InstanceSchema::addVariable(const string& name)
+{
+	map<string, size_t>::iterator it = columns.find(name);
+	if (it != columns.end())
+		return it->second;
+
+	size_t column = names.size();
+	columns[name] = column;
+	names.push_back(name);
+	return column;
+}
+
+bool InstanceSchema::contains(const string& name) const
+{
+	return columns.count(name) == 1;
+}
+
+size_t InstanceSchema::getColumn(const string& name) const
+{
+	map<string, size_t>::const_iterator it = columns.find(name);
+	if (it == columns.end())
+		throw runtime_error("Error, variable " + name + " is not in the schema");
+
+	return it->second;
+}
+
+const string& InstanceSchema::getName(size_t column) const
+{
+	return names[column];
+}
+
+size_t InstanceSchema::size() const
+{
+	return names.size();
+}
+
+InstanceTable::InstanceTable(const InstanceSchema& schema) :
+			schema(schema), columns(schema.size()), presence(schema.size())
+{
+}
+
+size_t InstanceTable::addRow(size_t id)
+{
+	size_t row = ids.size();
+	ids.push_back(id);
+
+	for (size_t column = 0; column < columns.size(); column++)
+	{
+		columns[column].push_back(0);
+		presence[column].push_back(false);
+	}
+
+	return row;
+}
+
+void InstanceTable::setValue(size_t row, size_t column, int value)
+{
+	columns[column][row] = value;
+	presence[column][row] = true;
+}
+
+const boost::dynamic_bitset<>& InstanceTable::getPresence(size_t column) const
+{
+	return presence[column];
+}
+
+size_t InstanceTable::size() const
+{
+	return ids.size();
+}
+
+void InstanceTable::clear()
+{
+	ids.clear();
+
+	for (size_t column = 0; column < columns.size(); column++)
+	{
+		columns[column].clear();
+		presence[column].clear();
+	}
+}
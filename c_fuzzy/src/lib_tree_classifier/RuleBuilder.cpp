@@ -32,8 +32,9 @@
 
 using namespace std;
 
-RuleBuilder::RuleBuilder(FuzzyKnowledgeBase& knowledgeBase) :
-			knowledgeBase(knowledgeBase), generator(NULL)
+RuleBuilder::RuleBuilder(FuzzyKnowledgeBase& knowledgeBase,
+			const InstanceSchema& schema) :
+			knowledgeBase(knowledgeBase), schema(schema), generator(NULL)
 {
 }
 
@@ -41,7 +42,7 @@ VariableGenerator* RuleBuilder::buildClassRule(FuzzyClass& fuzzyClass)
 {
 	fixNameSpace(fuzzyClass);
 	currentClass = fuzzyClass.getName();
-	generator = new VariableGenerator();
+	generator = new VariableGenerator(currentClass, schema);
 
 	NodePtr lhs;
 	NodePtr rhs;
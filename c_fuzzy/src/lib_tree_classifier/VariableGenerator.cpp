@@ -29,18 +29,20 @@
 
 using namespace std;
 
-VariableGenerator::VariableGenerator()
+VariableGenerator::VariableGenerator(const string& className,
+			const InstanceSchema& schema) :
+			className(className), schema(schema)
 {
 	varCounter = 0;
-
-	currentCandidates = NULL;
-	currentDependecies = NULL;
 }
 
 string VariableGenerator::addMatchVariable(Variable var, Variable target)
 {
 	string newVar = getNewVar();
-	matchVars[newVar] = MatchVar(var, target);
+	generatedVariables.insert(generatedVariables.begin() + matchVars.size(),
+				Variable(className, newVar));
+	matchVars.push_back(
+				MatchVar(getColumnVar(var, false), getColumnVar(target, true)));
 	return newVar;
 }
 
@@ -48,7 +50,12 @@ string VariableGenerator::addOnVariable(Variable var, Variable min,
 			Variable max)
 {
 	string newVar = getNewVar();
-	onVars[newVar] = OnVar(var, min, max);
+	generatedVariables.insert(
+				generatedVariables.begin() + matchVars.size() + onVars.size(),
+				Variable(className, newVar));
+	onVars.push_back(
+				OnVar(getColumnVar(var, true), getColumnVar(min, false),
+							getColumnVar(max, false)));
 	return newVar;
 }
 
@@ -56,104 +63,122 @@ string VariableGenerator::addInverseOnVariable(Variable min, Variable max,
 			Variable target)
 {
 	string newVar = getNewVar();
-	inverseVars[newVar] = InverseVar(min, max, target);
+	generatedVariables.push_back(Variable(className, newVar));
+	inverseVars.push_back(
+				InverseVar(getColumnVar(min, true), getColumnVar(max, true),
+							getColumnVar(target, false)));
 	return newVar;
 }
 
-ObjectProperties VariableGenerator::getGeneratedProperties(
-			ObjectMap& candidates, ObjectMap& dependencies)
+const vector<Variable>& VariableGenerator::getGeneratedVariables()
 {
-	ObjectProperties generated;
-	currentCandidates = &candidates;
-	currentDependecies = &dependencies;
-	generateMatches(generated);
-	generateOns(generated);
-	generateInverses(generated);
-
-	currentCandidates = NULL;
-	currentDependecies = NULL;
+	return generatedVariables;
+}
 
-	return generated;
+void VariableGenerator::getGeneratedValues(const InstanceTable& instances,
+			ObjectMap& candidates, ObjectMap& dependencies, vector<int>& values)
+{
+	resolveSlots(candidates, dependencies, NULL);
 
+	values.resize(generatedVariables.size());
+	generate(instances, 0, values.data());
 }
 
-void VariableGenerator::generateMatches(ObjectProperties& generated)
+void VariableGenerator::getGeneratedValues(const InstanceTable& instances,
+			ObjectMap& candidates, ObjectMap& dependencies,
+			const string& dependency, const RowVector& rows,
+			vector<int>& values)
 {
-	for (auto& it : matchVars)
-	{
-
-		string varName = it.first;
-		MatchVar& match = it.second;
-		Variable& var = match.var;
-		Variable& target = match.target;
+	resolveSlots(candidates, dependencies, &dependency);
 
-		int value = abs(getValue(var) - getDepValue(target));
+	//one block of values for each row of the dependency
+	size_t size = generatedVariables.size();
+	values.resize(rows.size() * size);
 
-		generated[varName] = value;
+	for (size_t i = 0; i < rows.size(); i++)
+	{
+		generate(instances, rows[i], values.data() + i * size);
 	}
 }
 
-void VariableGenerator::generateOns(ObjectProperties& generated)
+void VariableGenerator::resolveSlots(ObjectMap& candidates,
+			ObjectMap& dependencies, const string* dependency)
 {
-	for (auto& it : onVars)
+	for (size_t i = 0; i < slots.size(); i++)
 	{
-		string varName = it.first;
-		OnVar& on = it.second;
-		Variable& var = on.var;
-		Variable& min = on.min;
-		Variable& max = on.max;
-
-		int value = 100 * (getDepValue(var) - getValue(min))
-					/ (getValue(max) - getValue(min));
-
-		generated[varName] = value;
+		Slot& slot = slots[i];
+		batchSlots[i] = slot.dependency && dependency
+					&& slot.className == *dependency;
+
+		if (batchSlots[i])
+			continue;
+
+		ObjectMap::iterator it;
+		if (slot.dependency
+					&& (it = dependencies.find(slot.className))
+								!= dependencies.end())
+			slotRows[i] = it->second;
+		else if ((it = candidates.find(slot.className)) != candidates.end())
+			slotRows[i] = it->second;
+		else
+			throw runtime_error(
+						"Error, no class object " + slot.className
+									+ " found in inputs");
 	}
 }
 
-void VariableGenerator::generateInverses(ObjectProperties& generated)
+void VariableGenerator::generate(const InstanceTable& instances,
+			size_t batchRow, int* values)
 {
-	for (auto& it : inverseVars)
+	for (auto& match : matchVars)
+	{
+		int value = abs(
+					getValue(instances, match.var, batchRow)
+								- getValue(instances, match.target, batchRow));
+
+		*values++ = value;
+	}
+
+	for (auto& on : onVars)
 	{
-		string varName = it.first;
-		InverseVar& inverse = it.second;
-		Variable& target = inverse.target;
-		Variable& min = inverse.min;
-		Variable& max = inverse.max;
+		int min = getValue(instances, on.min, batchRow);
+		int max = getValue(instances, on.max, batchRow);
 
-		int value = 100 * (getValue(target) - getDepValue(min))
-					/ (getDepValue(max) - getDepValue(min));
+		int value = 100 * (getValue(instances, on.var, batchRow) - min)
+					/ (max - min);
 
-		generated[varName] = value;
+		*values++ = value;
 	}
-}
 
-int VariableGenerator::getValue(ObjectMap& inputs, Variable var)
-{
-	string& nameSpace = var.nameSpace;
-	string& domain = var.domain;
+	for (auto& inverse : inverseVars)
+	{
+		int min = getValue(instances, inverse.min, batchRow);
+		int max = getValue(instances, inverse.max, batchRow);
 
-	ObjectProperties& properties = inputs[nameSpace]->properties;
+		int value = 100 * (getValue(instances, inverse.target, batchRow) - min)
+					/ (max - min);
 
-	return properties[domain];
+		*values++ = value;
+	}
 }
 
-int VariableGenerator::getValue(Variable var)
+VariableGenerator::ColumnVar VariableGenerator::getColumnVar(
+			const Variable& var, bool dependency)
 {
-	return getValue(*currentCandidates, var);
-}
+	size_t column = schema.getColumn(var.domain);
 
-int VariableGenerator::getDepValue(Variable var)
-{
-	string& className = var.nameSpace;
+	for (size_t i = 0; i < slots.size(); i++)
+	{
+		if (slots[i].className == var.nameSpace
+					&& slots[i].dependency == dependency)
+			return ColumnVar(i, column);
+	}
 
-	if (currentDependecies->count(className) == 1)
-		return getValue(*currentDependecies, var);
-	else if (currentCandidates->count(className) == 1)
-		return getValue(*currentCandidates, var);
-	else
-		throw runtime_error(
-					"Error, no class object " + className + " found in inputs");
+	slots.push_back(Slot(var.nameSpace, dependency));
+	slotRows.push_back(0);
+	batchSlots.push_back(false);
 
+	return ColumnVar(slots.size() - 1, column);
 }
 
 string VariableGenerator::getNewVar()
@@ -163,4 +188,3 @@ string VariableGenerator::getNewVar()
 	string newVar = ss.str();
 	return newVar;
 }
-
@@ -58,7 +58,8 @@ int main(int argc, char **argv)
 		{
 			classifierHandler = new ClassifierServiceHandler(n,
 						clParser.getClassifierKnowledgeBase(),
-						clParser.getClassifier());
+						clParser.getClassifier(), clParser.getCacheSize(),
+						clParser.getCacheQuantization());
 
 			ROS_INFO("Classifier setup correctly");
 		}
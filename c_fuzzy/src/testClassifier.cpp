@@ -32,33 +32,25 @@ using namespace std;
 
 void addInstances(ClassifierReasoner& reasoner)
 {
-	ObjectInstance* instance = new ObjectInstance();
-	instance->id = 0;
-	instance->properties["x"] = 100;
-	instance->properties["y"] = 100;
-	reasoner.addInstance(instance);
+	size_t row = reasoner.addInstance(0);
+	reasoner.setProperty(row, "x", 100);
+	reasoner.setProperty(row, "y", 100);
 
-	instance = new ObjectInstance();
-	instance->id = 1;
-	instance->properties["x"] = 105;
-	instance->properties["y"] = 105;
-	reasoner.addInstance(instance);
+	row = reasoner.addInstance(1);
+	reasoner.setProperty(row, "x", 105);
+	reasoner.setProperty(row, "y", 105);
 
-	instance = new ObjectInstance();
-	instance->id = 2;
-	instance->properties["xMin"] = 0;
-	instance->properties["xMax"] = 20;
-	instance->properties["yMin"] = 0;
-	instance->properties["yMax"] = 40;
-	instance->properties["formFactor"] = 2700;
-	instance->properties["area"] = 150000;
-	reasoner.addInstance(instance);
+	row = reasoner.addInstance(2);
+	reasoner.setProperty(row, "xMin", 0);
+	reasoner.setProperty(row, "xMax", 20);
+	reasoner.setProperty(row, "yMin", 0);
+	reasoner.setProperty(row, "yMax", 40);
+	reasoner.setProperty(row, "formFactor", 2700);
+	reasoner.setProperty(row, "area", 150000);
 
-	instance = new ObjectInstance();
-	instance->id = 3;
-	instance->properties["x"] = 15;
-	instance->properties["y"] = 20;
-	reasoner.addInstance(instance);
+	row = reasoner.addInstance(3);
+	reasoner.setProperty(row, "x", 15);
+	reasoner.setProperty(row, "y", 20);
 }
 
 int main(int argc, char *argv[])
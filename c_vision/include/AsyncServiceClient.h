@@ -0,0 +1,214 @@
+/*
+ * c_vision,
+ *
+ *
+ * Copyright (C) 2014 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of c_vision.
+ *
+ * c_vision is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * c_vision is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with c_vision.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ASYNCSERVICECLIENT_H_
+#define ASYNCSERVICECLIENT_H_
+
+#include <ros/ros.h>
+#include <ros/callback_queue.h>
+
+#include <deque>
+#include <algorithm>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+//runs a completion on the ros spinner thread
+class CompletionCallback: public ros::CallbackInterface
+{
+public:
+	CompletionCallback(const std::function<void()>& completion) :
+				completion(completion)
+	{
+	}
+
+	virtual CallResult call()
+	{
+		completion();
+		return Success;
+	}
+
+private:
+	std::function<void()> completion;
+};
+
+//service calls made by a worker thread, with a bounded queue
+template<class Service>
+class AsyncServiceClient
+{
+public:
+	//the caller gets the seconds left before the request deadline
+	typedef std::function<bool(Service&, double)> Caller;
+	typedef std::function<void(Service&, bool)> Completion;
+
+public:
+	AsyncServiceClient(const Caller& caller, size_t maxInFlight,
+				double deadline) :
+				caller(caller), maxInFlight(std::max<size_t>(maxInFlight, 2)),
+				deadline(deadline)
+	{
+		running = true;
+		executing = false;
+		worker = std::thread(&AsyncServiceClient::run, this);
+	}
+
+	void setLimits(size_t maxInFlight, double deadline)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->maxInFlight = std::max<size_t>(maxInFlight, 2);
+		this->deadline = deadline;
+	}
+
+	void call(const std::shared_ptr<Service>& serviceCall,
+				const Completion& completion)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		//drop the oldest waiting request, it would be stale anyway
+		while (!queue.empty()
+					&& queue.size() + (executing ? 1 : 0) >= maxInFlight)
+		{
+			ROS_WARN("Classification queue full, dropping a request");
+			complete(queue.front(), false);
+			queue.pop_front();
+		}
+
+		Request request;
+		request.serviceCall = serviceCall;
+		request.completion = completion;
+		request.deadline = ros::WallTime::now() + ros::WallDuration(deadline);
+		queue.push_back(request);
+
+		condition.notify_one();
+	}
+
+	~AsyncServiceClient()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			running = false;
+			queue.clear();
+			condition.notify_one();
+		}
+
+		worker.join();
+		ros::getGlobalCallbackQueue()->removeByID(
+					reinterpret_cast<uint64_t>(this));
+	}
+
+private:
+	struct Request
+	{
+		std::shared_ptr<Service> serviceCall;
+		Completion completion;
+		ros::WallTime deadline;
+	};
+
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (running)
+		{
+			if (queue.empty())
+			{
+				condition.wait(lock);
+				continue;
+			}
+
+			Request request = queue.front();
+			queue.pop_front();
+
+			if (ros::WallTime::now() > request.deadline)
+			{
+				ROS_WARN("Classification request expired");
+				complete(request, false);
+				continue;
+			}
+
+			double timeout = (request.deadline - ros::WallTime::now()).toSec();
+
+			executing = true;
+			lock.unlock();
+			bool success = invoke(request, timeout);
+			lock.lock();
+			executing = false;
+
+			//results past the deadline belong to an old frame
+			if (success && ros::WallTime::now() > request.deadline)
+			{
+				ROS_WARN("Classification response arrived too late");
+				success = false;
+			}
+
+			complete(request, success);
+		}
+	}
+
+	//a failing call must not take down the worker
+	bool invoke(const Request& request, double timeout)
+	{
+		try
+		{
+			return caller(*request.serviceCall, timeout);
+		}
+		catch (std::exception& e)
+		{
+			ROS_ERROR_STREAM("Classification call failed: " << e.what());
+			return false;
+		}
+	}
+
+	void complete(const Request& request, bool success)
+	{
+		std::shared_ptr<Service> serviceCall = request.serviceCall;
+		Completion completion = request.completion;
+
+		ros::CallbackInterfacePtr callback(new CompletionCallback([=]()
+		{
+			completion(*serviceCall, success);
+		}));
+
+		ros::getGlobalCallbackQueue()->addCallback(callback,
+					reinterpret_cast<uint64_t>(this));
+	}
+
+private:
+	Caller caller;
+	size_t maxInFlight;
+	double deadline;
+
+	std::deque<Request> queue;
+	bool running;
+	bool executing;
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::thread worker;
+};
+
+#endif /* ASYNCSERVICECLIENT_H_ */
@@ -28,24 +28,61 @@
 #include <image_transport/image_transport.h>
 #include <sensor_msgs/Imu.h>
 #include <c_fuzzy/Classification.h>
+#include <c_fuzzy/BatchClassification.h>
+#include <ClassificationEngine.h>
+#include <CompactCodec.h>
 #include <tf/transform_listener.h>
 #include <opencv2/core/core.hpp>
 
+#include <memory>
+#include <mutex>
+
 #include "ParameterServer.h"
+#include "AsyncServiceClient.h"
 
 class BaseLogic
 {
 public:
 	BaseLogic(ros::NodeHandle& n, ParameterServer& parameters);
 	void handleImu(const sensor_msgs::Imu& imu);
+	virtual ~BaseLogic();
 
 protected:
+	typedef AsyncServiceClient<c_fuzzy::Classification> ClassificationClient;
+	typedef AsyncServiceClient<c_fuzzy::BatchClassification> BatchClassificationClient;
+
 	void connectToClassificationServer();
-	void callClassificationService(c_fuzzy::Classification& serviceCall);
+	void callClassificationService(
+				const std::shared_ptr<c_fuzzy::Classification>& serviceCall,
+				const ClassificationClient::Completion& completion);
+	void callBatchClassificationService(
+				const std::shared_ptr<c_fuzzy::BatchClassification>& serviceCall,
+				const BatchClassificationClient::Completion& completion);
 	void sendFeatures(
 				const std::vector<std::pair<std::vector<cv::Point>, std::string> >& features,
 				ros::Time t, size_t id = 0);
 
+private:
+	//blocking calls, run by the client workers
+	bool classify(c_fuzzy::Classification& serviceCall, double timeout);
+	bool classify(c_fuzzy::BatchClassification& serviceCall, double timeout);
+	bool loadSchema(double timeout);
+	void resetSchema();
+
+	template<class Service>
+	bool callService(ros::ServiceClient& client, Service& serviceCall,
+				double timeout)
+	{
+		if (client.isValid())
+			return client.call(serviceCall);
+
+		ROS_ERROR("Service down, waiting reconnection...");
+		if (client.waitForExistence(ros::Duration(std::max(timeout, 0.0))))
+			client = n.serviceClient<Service>(client.getService(), true);
+
+		return false;
+	}
+
 protected:
 	//Ros management
 	ros::NodeHandle& n;
@@ -55,6 +92,18 @@ protected:
 	image_transport::Subscriber imageSubscriber;
 	tf::TransformListener tfListener;
 	ros::ServiceClient classificationService;
+	ros::ServiceClient batchClassificationService;
+	ClassificationEngine* engine;
+	std::mutex engineMutex;
+
+	//packed messages, the schema is fetched on the first call
+	ros::ServiceClient compactClassificationService;
+	ros::ServiceClient schemaService;
+	CompactCodec* codec;
+	std::mutex compactMutex;
+
+	ClassificationClient* classificationClient;
+	BatchClassificationClient* batchClassificationClient;
 
 	ros::Publisher publisher;
 
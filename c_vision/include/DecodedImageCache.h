@@ -0,0 +1,71 @@
+/*
+ * c_vision,
+ *
+ *
+ * Copyright (C) 2014 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of c_vision.
+ *
+ * c_vision is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * c_vision is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with c_vision.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef DECODEDIMAGECACHE_H_
+#define DECODEDIMAGECACHE_H_
+
+#include <ros/ros.h>
+#include <sensor_msgs/Image.h>
+#include <opencv2/core/core.hpp>
+
+#include <map>
+
+//camera frames by stamp, decoded to BGR8 at most once
+class DecodedImageCache
+{
+public:
+	DecodedImageCache(size_t budget);
+
+	void add(const sensor_msgs::ImageConstPtr& msg);
+	bool getElemBeforeTime(const ros::Time& t, cv::Mat& image,
+				ros::Time& stamp);
+
+	inline size_t getBytes()
+	{
+		return bytes;
+	}
+
+private:
+	struct Entry
+	{
+		Entry() :
+					bytes(0)
+		{
+		}
+
+		sensor_msgs::ImageConstPtr msg;
+		cv::Mat image;
+		size_t bytes;
+	};
+
+	void decode(Entry& entry);
+	void evict();
+
+private:
+	std::map<ros::Time, Entry> frames;
+	size_t budget;
+	size_t bytes;
+};
+
+#endif /* DECODEDIMAGECACHE_H_ */
@@ -32,6 +32,16 @@
 
 #include "SimpleDetector.h"
 
+#include <vector>
+
+//detections of a frame, waiting for the classification results
+struct FrameDetections
+{
+	ros::Time t;
+	cv::Mat image;
+	DetectionArena* arena;
+};
+
 class DetectorLogic : public BaseLogic
 {
 public:
@@ -40,13 +50,16 @@ public:
 
 private:
 	void detect(const cv_bridge::CvImagePtr& cv_ptr);
-	void classify(ros::Time t);
-	void display(const cv_bridge::CvImagePtr& cv_ptr);
+	void classify(const cv_bridge::CvImagePtr& cv_ptr, ros::Time t);
+	void display(FrameDetections& frame);
 
 private:
 	//Data needed to detect objects
 	SimpleDetector detector;
 
+	//detections of the frames in flight
+	DetectionArenaPool arenas;
+
 };
 
 #endif /* DETECTORLOGIC_H_ */
@@ -0,0 +1,320 @@
+/*
+ * c_vision,
+ *
+ *
+ * Copyright (C) 2015 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of c_vision.
+ *
+ * c_vision is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * c_vision is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with c_vision.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_FHOMT_FLATMORPHOLOGY_H_
+#define INCLUDE_FHOMT_FLATMORPHOLOGY_H_
+
+#include "FuzzyConjuction.h"
+#include "FuzzyImplication.h"
+
+#include <opencv2/opencv.hpp>
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * Operators that are non decreasing in the image value and that ignore the
+ * zeros of the structuring element. Over a flat structuring element of
+ * value b, the extremum of op(b, f) is then op(b, extremum of f).
+ */
+template<class Operator>
+struct FlatReducible
+{
+	static constexpr bool value = false;
+};
+
+template<>
+struct FlatReducible<LukasiewiczConjunction>
+{
+	static constexpr bool value = true;
+};
+
+template<>
+struct FlatReducible<MinimumConjunction>
+{
+	static constexpr bool value = true;
+};
+
+template<>
+struct FlatReducible<ProductConjunction>
+{
+	static constexpr bool value = true;
+};
+
+template<>
+struct FlatReducible<NilpMinimumConjunction>
+{
+	static constexpr bool value = true;
+};
+
+template<>
+struct FlatReducible<LukasiewiczImplication>
+{
+	static constexpr bool value = true;
+};
+
+template<>
+struct FlatReducible<MinimumImplication>
+{
+	static constexpr bool value = true;
+};
+
+template<>
+struct FlatReducible<ProductImplication>
+{
+	static constexpr bool value = true;
+};
+
+//a structuring element with a single positive value over a rectangle
+class FlatElement
+{
+public:
+	FlatElement(const cv::Mat_<double>& structuringElement)
+	{
+		int minX = structuringElement.cols;
+		int minY = structuringElement.rows;
+		int maxX = -1;
+		int maxY = -1;
+
+		for (int j = 0; j < structuringElement.rows; j++)
+			for (int i = 0; i < structuringElement.cols; i++)
+				if (structuringElement(j, i) != 0)
+				{
+					minX = std::min(minX, i);
+					minY = std::min(minY, j);
+					maxX = std::max(maxX, i);
+					maxY = std::max(maxY, j);
+				}
+
+		value = 0;
+		flat = true;
+
+		//an empty element leaves the identity of the extremum
+		if (maxX < 0)
+			return;
+
+		support = cv::Rect(minX, minY, maxX - minX + 1, maxY - minY + 1);
+		value = structuringElement(minY, minX);
+		flat = value > 0;
+
+		for (int j = support.y; flat && j < support.br().y; j++)
+			for (int i = support.x; flat && i < support.br().x; i++)
+				flat = structuringElement(j, i) == value;
+	}
+
+	inline bool isFlat() const
+	{
+		return flat;
+	}
+
+	inline bool isEmpty() const
+	{
+		return support.area() == 0;
+	}
+
+	inline double getValue() const
+	{
+		return value;
+	}
+
+	inline const cv::Rect& getSupport() const
+	{
+		return support;
+	}
+
+private:
+	cv::Rect support;
+	double value;
+	bool flat;
+};
+
+/**
+ * Running maximum and minimum over a rectangle, using the van Herk/Gil-Werman
+ * algorithm. The rectangle is split into a row pass and a column pass; each
+ * pass costs three comparisons per pixel, whatever the window length.
+ * The output pixel (y, x) is the extremum of the window whose top left
+ * corner is (y, x), so the output is smaller than the input.
+ */
+class FlatMorphology
+{
+public:
+	template<typename Pixel>
+	static inline cv::Mat_<Pixel> maxFilter(const cv::Mat_<Pixel>& input,
+				const cv::Size& window)
+	{
+		return filter(input, window, Maximum());
+	}
+
+	template<typename Pixel>
+	static inline cv::Mat_<Pixel> minFilter(const cv::Mat_<Pixel>& input,
+				const cv::Size& window)
+	{
+		return filter(input, window, Minimum());
+	}
+
+	//runs function(y) for each row in range, in parallel
+	template<class Function>
+	static inline void parallelRows(const cv::Range& range,
+				const Function& function)
+	{
+		if (range.start < range.end)
+			cv::parallel_for_(range, RowBody<Function>(function));
+	}
+
+private:
+	struct Maximum
+	{
+		template<typename Pixel>
+		inline Pixel operator()(Pixel a, Pixel b) const
+		{
+			return std::max(a, b);
+		}
+	};
+
+	struct Minimum
+	{
+		template<typename Pixel>
+		inline Pixel operator()(Pixel a, Pixel b) const
+		{
+			return std::min(a, b);
+		}
+	};
+
+	template<class Function>
+	class RowBody: public cv::ParallelLoopBody
+	{
+	public:
+		RowBody(const Function& function) :
+					function(function)
+		{
+		}
+
+		virtual void operator()(const cv::Range& rows) const
+		{
+			for (int y = rows.start; y < rows.end; y++)
+				function(y);
+		}
+
+	private:
+		const Function& function;
+	};
+
+	template<typename Pixel, class Extremum>
+	static inline cv::Mat_<Pixel> filter(const cv::Mat_<Pixel>& input,
+				const cv::Size& window, const Extremum& extremum)
+	{
+		cv::Mat_<Pixel> rowsOutput = input;
+
+		if (window.width > 1)
+			rowsOutput = filterRows(input, window.width, extremum);
+
+		if (window.height > 1)
+			return filterColumns(rowsOutput, window.height, extremum);
+
+		return rowsOutput;
+	}
+
+	template<typename Pixel, class Extremum>
+	static inline cv::Mat_<Pixel> filterRows(const cv::Mat_<Pixel>& input,
+				int width, const Extremum& extremum)
+	{
+		cv::Mat_<Pixel> output(input.rows, input.cols - width + 1);
+
+		parallelRows(cv::Range(0, input.rows), [&](int y)
+		{
+			//prefix and suffix extrema inside blocks of the window width
+			thread_local std::vector<Pixel> prefix;
+			thread_local std::vector<Pixel> suffix;
+			prefix.resize(input.cols);
+			suffix.resize(input.cols);
+
+			const Pixel* f = input[y];
+
+			for (int start = 0; start < input.cols; start += width)
+			{
+				int end = std::min(start + width, input.cols);
+
+				prefix[start] = f[start];
+				for (int i = start + 1; i < end; i++)
+					prefix[i] = extremum(prefix[i - 1], f[i]);
+
+				suffix[end - 1] = f[end - 1];
+				for (int i = end - 2; i >= start; i--)
+					suffix[i] = extremum(suffix[i + 1], f[i]);
+			}
+
+			Pixel* o = output[y];
+			for (int x = 0; x < output.cols; x++)
+				o[x] = extremum(suffix[x], prefix[x + width - 1]);
+		});
+
+		return output;
+	}
+
+	//the same as filterRows, on whole rows at a time
+	template<typename Pixel, class Extremum>
+	static inline cv::Mat_<Pixel> filterColumns(const cv::Mat_<Pixel>& input,
+				int height, const Extremum& extremum)
+	{
+		cv::Mat_<Pixel> prefix(input.size());
+		cv::Mat_<Pixel> suffix(input.size());
+		cv::Mat_<Pixel> output(input.rows - height + 1, input.cols);
+
+		int blocks = (input.rows + height - 1) / height;
+
+		parallelRows(cv::Range(0, blocks), [&](int block)
+		{
+			int start = block * height;
+			int end = std::min(start + height, input.rows);
+
+			input.row(start).copyTo(prefix.row(start));
+			for (int j = start + 1; j < end; j++)
+				extremumRow(prefix[j - 1], input[j], prefix[j], input.cols,
+							extremum);
+
+			input.row(end - 1).copyTo(suffix.row(end - 1));
+			for (int j = end - 2; j >= start; j--)
+				extremumRow(suffix[j + 1], input[j], suffix[j], input.cols,
+							extremum);
+		});
+
+		parallelRows(cv::Range(0, output.rows), [&](int y)
+		{
+			extremumRow(suffix[y], prefix[y + height - 1], output[y], input.cols,
+						extremum);
+		});
+
+		return output;
+	}
+
+	template<typename Pixel, class Extremum>
+	static inline void extremumRow(const Pixel* a, const Pixel* b, Pixel* out,
+				int cols, const Extremum& extremum)
+	{
+		for (int x = 0; x < cols; x++)
+			out[x] = extremum(a[x], b[x]);
+	}
+
+};
+
+#endif /* INCLUDE_FHOMT_FLATMORPHOLOGY_H_ */
@@ -36,7 +36,7 @@ public:
 	}
 };
 
-class LukasiewiczConjunction: public FuzzyConjunction
+class LukasiewiczConjunction final: public FuzzyConjunction
 {
 public:
 	virtual inline double operator()(double x, double y) const
@@ -49,7 +49,7 @@ public:
 	}
 };
 
-class MinimumConjunction: public FuzzyConjunction
+class MinimumConjunction final: public FuzzyConjunction
 {
 public:
 	virtual inline double operator()(double x, double y) const
@@ -62,7 +62,7 @@ public:
 	}
 };
 
-class ProductConjunction: public FuzzyConjunction
+class ProductConjunction final: public FuzzyConjunction
 {
 public:
 	virtual inline double operator()(double x, double y) const
@@ -75,7 +75,7 @@ public:
 	}
 };
 
-class NilpMinimumConjunction: public FuzzyConjunction
+class NilpMinimumConjunction final: public FuzzyConjunction
 {
 public:
 	virtual inline double operator()(double x, double y) const
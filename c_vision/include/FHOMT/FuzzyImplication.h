@@ -36,7 +36,7 @@ public:
 	}
 };
 
-class LukasiewiczImplication: public FuzzyImplication
+class LukasiewiczImplication final: public FuzzyImplication
 {
 public:
 	virtual inline double operator()(double x, double y) const
@@ -50,7 +50,7 @@ public:
 	}
 };
 
-class MinimumImplication: public FuzzyImplication
+class MinimumImplication final: public FuzzyImplication
 {
 public:
 	virtual inline double operator()(double x, double y) const
@@ -67,7 +67,7 @@ public:
 	}
 };
 
-class ProductImplication: public FuzzyImplication
+class ProductImplication final: public FuzzyImplication
 {
 public:
 	virtual inline double operator()(double x, double y) const
@@ -84,7 +84,7 @@ public:
 	}
 };
 
-class NilpMinimumImplication: public FuzzyImplication
+class NilpMinimumImplication final: public FuzzyImplication
 {
 public:
 	virtual inline double operator()(double x, double y) const
@@ -26,175 +26,395 @@
 
 #include "FuzzyConjuction.h"
 #include "FuzzyImplication.h"
+#include "FlatMorphology.h"
 
 #include <opencv2/opencv.hpp>
 
+#include <vector>
+
+/**
+ * Fuzzy morphology over double or float images.
+ * The operators are template parameters, so that the final operator classes
+ * are inlined in the row loops. Rows are processed in parallel.
+ * Flat rectangular structuring elements, with operators that are non
+ * decreasing in the image value, are reduced to running extrema.
+ */
 class MorphOp
 {
 public:
-	static inline cv::Mat f_homt(const cv::Mat_<double>& inputImage,
-				const cv::Mat_<double>& structuringElement, const FuzzyConjunction& T,
-				const FuzzyImplication& I)
+	template<typename Pixel, class Conjunction, class Implication>
+	static inline cv::Mat f_homt(const cv::Mat_<Pixel>& inputImage,
+				const cv::Mat_<double>& structuringElement, const Conjunction& T,
+				const Implication& I)
 	{
-		cv::Size seSize = structuringElement.size();
-		cv::Size imageSize = inputImage.size();
-
-		cv::Mat_<double> R(imageSize, 0);
+		cv::Mat_<Pixel> R(inputImage.size(), 0);
 
-		unsigned int startX = std::floor(seSize.width / 2);
-		unsigned int startY = floor(seSize.height / 2);
+		cv::Mat_<double> Be = cv::max(0, structuringElement);
+		cv::Mat_<double> Bd = -cv::min(0, structuringElement);
 
-		unsigned int endX = imageSize.width - startX;
-		unsigned int endY = imageSize.height - startY;
+		FlatElement flatBe(Be);
+		FlatElement flatBd(Bd);
 
-		cv::Mat Be = cv::max(0, structuringElement);
-		cv::Mat Bd = -cv::min(0, structuringElement);
-
-		for (unsigned int i = startX; i < endX; i++)
+		if (FlatReducible<Conjunction>::value && FlatReducible<Implication>::value
+					&& flatBe.isFlat() && flatBd.isFlat())
 		{
-			for (unsigned j = startY; j < endY; j++)
-			{
-				R(j, i) = f_homt_local(inputImage, Be, Bd, i, j, T, I);
-			}
+			flatHomt(inputImage, structuringElement.size(), flatBe, flatBd, T, I,
+						R);
+			return R;
 		}
 
-		return R;
+		HomtBody<Pixel, Conjunction, Implication> body(inputImage, Be, Bd, T, I,
+					R);
+		parallelRows(inputImage, structuringElement, body);
 
+		return R;
 	}
 
-	static inline cv::Mat f_erode(const cv::Mat_<double>& inputImage,
-				const cv::Mat_<double>& structuringElement, const FuzzyImplication& I)
+	template<typename Pixel, class Implication>
+	static inline cv::Mat f_erode(const cv::Mat_<Pixel>& inputImage,
+				const cv::Mat_<double>& structuringElement, const Implication& I)
 	{
-		cv::Size seSize = structuringElement.size();
-		cv::Size imageSize = inputImage.size();
+		cv::Mat_<Pixel> R(inputImage.size(), 0);
+
+		FlatElement flatB(structuringElement);
+
+		if (FlatReducible<Implication>::value && flatB.isFlat())
+		{
+			flatErode(inputImage, structuringElement.size(), flatB, I, R);
+			return R;
+		}
+
+		ErodeBody<Pixel, Implication> body(inputImage, structuringElement, I, R);
+		parallelRows(inputImage, structuringElement, body);
 
-		cv::Mat_<double> R(imageSize, 0);
+		return R;
+	}
 
-		unsigned int startX = std::floor(seSize.width / 2);
-		unsigned int startY = floor(seSize.height / 2);
+	template<typename Pixel, class Conjunction>
+	static inline cv::Mat f_dilate(const cv::Mat_<Pixel>& inputImage,
+				const cv::Mat_<double>& structuringElement, const Conjunction& T)
+	{
+		cv::Mat_<Pixel> R(inputImage.size(), 0);
 
-		unsigned int endX = imageSize.width - startX;
-		unsigned int endY = imageSize.height - startY;
+		FlatElement flatB(structuringElement);
 
-		for (unsigned int i = startX; i < endX; i++)
+		if (FlatReducible<Conjunction>::value && flatB.isFlat())
 		{
-			for (unsigned j = startY; j < endY; j++)
-			{
-				R(j, i) = f_erode_local(inputImage, structuringElement, i, j,
-							I);
-			}
+			flatDilate(inputImage, structuringElement.size(), flatB, T, R);
+			return R;
 		}
 
+		DilateBody<Pixel, Conjunction> body(inputImage, structuringElement, T, R);
+		parallelRows(inputImage, structuringElement, body);
+
 		return R;
 	}
 
-	static inline cv::Mat f_dilate(const cv::Mat_<double>& inputImage,
-				const cv::Mat_<double>& structuringElement, const FuzzyConjunction& T)
+private:
+	//output pixels whose neighbourhood lies inside the image
+	struct Window
 	{
-		cv::Size seSize = structuringElement.size();
-		cv::Size imageSize = inputImage.size();
+		Window(const cv::Size& imageSize, const cv::Size& seSize)
+		{
+			offsetX = seSize.width / 2;
+			offsetY = seSize.height / 2;
+			startX = offsetX;
+			endX = std::max(startX, imageSize.width - offsetX);
+		}
 
-		cv::Mat_<double> R(imageSize, 0);
+		int offsetX;
+		int offsetY;
+		int startX;
+		int endX;
+	};
 
-		unsigned int startX = std::floor(seSize.width / 2);
-		unsigned int startY = floor(seSize.height / 2);
+	template<typename Pixel, class Body>
+	static inline void parallelRows(const cv::Mat_<Pixel>& inputImage,
+				const cv::Mat_<double>& structuringElement, const Body& body)
+	{
+		int startY = structuringElement.rows / 2;
+		int endY = inputImage.rows - startY;
 
-		unsigned int endX = imageSize.width - startX;
-		unsigned int endY = imageSize.height - startY;
+		if (startY < endY)
+			cv::parallel_for_(cv::Range(startY, endY), body);
+	}
 
-		for (unsigned int i = startX; i < endX; i++)
+	//min over the structuring element of I(B, input), for a whole row
+	template<typename Pixel, class Implication>
+	static inline void erodeRow(const cv::Mat_<Pixel>& inputImage,
+				const cv::Mat_<double>& B, const Implication& I,
+				const Window& w, int y, double* minV)
+	{
+		for (int i = 0; i < B.cols; i++)
 		{
-			for (unsigned j = startY; j < endY; j++)
+			for (int j = 0; j < B.rows; j++)
 			{
-				R(j, i) = f_dilate_local(inputImage, structuringElement, i, j,
-							T);
+				const double b = B(j, i);
+				const Pixel* p = inputImage[y - w.offsetY + j] + i - w.offsetX;
+
+				for (int x = w.startX; x < w.endX; x++)
+					minV[x] = std::min(minV[x], I(b, static_cast<double>(p[x])));
 			}
 		}
-
-		return R;
 	}
 
-private:
-	static inline double f_homt_local(const cv::Mat_<double>& inputImage,
-				const cv::Mat_<double>& Be, const cv::Mat_<double>& Bd, unsigned int x,
-				unsigned int y, const FuzzyConjunction& T,
-				const FuzzyImplication& I)
+	//max over the structuring element of T(B, input), for a whole row
+	template<typename Pixel, class Conjunction>
+	static inline void dilateRow(const cv::Mat_<Pixel>& inputImage,
+				const cv::Mat_<double>& B, const Conjunction& T,
+				const Window& w, int y, double* maxV)
 	{
-		double minVe = 1.0;
-		double maxVd = 0.0;
+		for (int i = 0; i < B.cols; i++)
+		{
+			for (int j = 0; j < B.rows; j++)
+			{
+				const double b = B(j, i);
+				const Pixel* p = inputImage[y - w.offsetY + j] + i - w.offsetX;
 
-		cv::Size seSize = Be.size();
+				for (int x = w.startX; x < w.endX; x++)
+					maxV[x] = std::max(maxV[x], T(b, static_cast<double>(p[x])));
+			}
+		}
+	}
 
-		unsigned int offsetX = floor(seSize.width / 2);
-		unsigned int offsetY = floor(seSize.height / 2);
+	//running extremum of the input over the support of a flat element
+	template<typename Pixel>
+	class FlatExtremum
+	{
+	public:
+		FlatExtremum(const cv::Mat_<Pixel>& inputImage, const FlatElement& B,
+					const Window& w, bool maximum) :
+					B(B), w(w)
+		{
+			if (B.isEmpty())
+				return;
+
+			if (maximum)
+				extremum = FlatMorphology::maxFilter(inputImage,
+							B.getSupport().size());
+			else
+				extremum = FlatMorphology::minFilter(inputImage,
+							B.getSupport().size());
+		}
 
-		for (unsigned int i = 0; i < seSize.width; i++)
+		//the extremum row of the output row y, indexed by the output column
+		inline const Pixel* row(int y) const
 		{
-			for (unsigned int j = 0; j < seSize.height; j++)
-			{
-				//Erosion
-				double currentVe = I(Be(j, i),
-							inputImage(y - offsetY + j, x - offsetX + i));
-				minVe = std::min(minVe, currentVe);
-
-				//Dilation
-				double currentVd = T(Bd(j, i),
-							inputImage(y - offsetY + j, x - offsetX + i));
-				maxVd = std::max(maxVd, currentVd);
-			}
+			if (B.isEmpty())
+				return NULL;
+
+			const cv::Rect& support = B.getSupport();
+			return extremum[y - w.offsetY + support.y] + support.x - w.offsetX;
 		}
 
-		return T(minVe, 1 - maxVd);
+	private:
+		const FlatElement& B;
+		const Window& w;
+		cv::Mat_<Pixel> extremum;
+	};
+
+	//min over the support of I(B, input) is I(B, min over the support)
+	template<typename Pixel, class Implication>
+	static inline double flatErosion(const Pixel* minRow, const FlatElement& B,
+				const Implication& I, int x)
+	{
+		if (!minRow)
+			return 1.0;
+
+		return std::min(1.0, I(B.getValue(), static_cast<double>(minRow[x])));
+	}
+
+	//max over the support of T(B, input) is T(B, max over the support)
+	template<typename Pixel, class Conjunction>
+	static inline double flatDilation(const Pixel* maxRow, const FlatElement& B,
+				const Conjunction& T, int x)
+	{
+		if (!maxRow)
+			return 0.0;
+
+		return std::max(0.0, T(B.getValue(), static_cast<double>(maxRow[x])));
+	}
+
+	template<typename Pixel, class Implication>
+	static inline void flatErode(const cv::Mat_<Pixel>& inputImage,
+				const cv::Size& seSize, const FlatElement& B, const Implication& I,
+				cv::Mat_<Pixel>& R)
+	{
+		Window w(inputImage.size(), seSize);
+		if (w.startX >= w.endX || 2 * w.offsetY >= inputImage.rows)
+			return;
+
+		FlatExtremum<Pixel> minF(inputImage, B, w, false);
+
+		FlatMorphology::parallelRows(
+					cv::Range(w.offsetY, inputImage.rows - w.offsetY), [&](int y)
+					{
+						const Pixel* minRow = minF.row(y);
+						Pixel* r = R[y];
+
+						for (int x = w.startX; x < w.endX; x++)
+							r[x] = static_cast<Pixel>(flatErosion(minRow, B, I, x));
+					});
 	}
 
-	static inline double f_dilate_local(const cv::Mat_<double>& inputImage,
-				const cv::Mat_<double>& B, unsigned int x, unsigned int y,
-				const FuzzyConjunction& T)
+	template<typename Pixel, class Conjunction>
+	static inline void flatDilate(const cv::Mat_<Pixel>& inputImage,
+				const cv::Size& seSize, const FlatElement& B, const Conjunction& T,
+				cv::Mat_<Pixel>& R)
 	{
+		Window w(inputImage.size(), seSize);
+		if (w.startX >= w.endX || 2 * w.offsetY >= inputImage.rows)
+			return;
+
+		FlatExtremum<Pixel> maxF(inputImage, B, w, true);
 
-		double maxV = 0.0;
+		FlatMorphology::parallelRows(
+					cv::Range(w.offsetY, inputImage.rows - w.offsetY), [&](int y)
+					{
+						const Pixel* maxRow = maxF.row(y);
+						Pixel* r = R[y];
 
-		cv::Size seSize = B.size();
+						for (int x = w.startX; x < w.endX; x++)
+							r[x] = static_cast<Pixel>(flatDilation(maxRow, B, T, x));
+					});
+	}
 
-		unsigned int offsetX = floor(seSize.width / 2);
-		unsigned int offsetY = floor(seSize.height / 2);
+	template<typename Pixel, class Conjunction, class Implication>
+	static inline void flatHomt(const cv::Mat_<Pixel>& inputImage,
+				const cv::Size& seSize, const FlatElement& Be,
+				const FlatElement& Bd, const Conjunction& T, const Implication& I,
+				cv::Mat_<Pixel>& R)
+	{
+		Window w(inputImage.size(), seSize);
+		if (w.startX >= w.endX || 2 * w.offsetY >= inputImage.rows)
+			return;
+
+		FlatExtremum<Pixel> minF(inputImage, Be, w, false);
+		FlatExtremum<Pixel> maxF(inputImage, Bd, w, true);
+
+		FlatMorphology::parallelRows(
+					cv::Range(w.offsetY, inputImage.rows - w.offsetY), [&](int y)
+					{
+						const Pixel* minRow = minF.row(y);
+						const Pixel* maxRow = maxF.row(y);
+						Pixel* r = R[y];
+
+						for (int x = w.startX; x < w.endX; x++)
+						{
+							double eroded = flatErosion(minRow, Be, I, x);
+							double dilated = flatDilation(maxRow, Bd, T, x);
+							r[x] = static_cast<Pixel>(T(eroded, 1 - dilated));
+						}
+					});
+	}
 
-		for (unsigned int i = 0; i < seSize.width; i++)
+	template<typename Pixel, class Implication>
+	class ErodeBody: public cv::ParallelLoopBody
+	{
+	public:
+		ErodeBody(const cv::Mat_<Pixel>& inputImage, const cv::Mat_<double>& B,
+					const Implication& I, cv::Mat_<Pixel>& R) :
+					inputImage(inputImage), B(B), I(I), R(R),
+					w(inputImage.size(), B.size())
 		{
-			for (unsigned int j = 0; j < seSize.height; j++)
+		}
+
+		virtual void operator()(const cv::Range& rows) const
+		{
+			std::vector<double> minV(inputImage.cols);
+
+			for (int y = rows.start; y < rows.end; y++)
 			{
-				double currentV = T(B(j, i),
-							inputImage(y - offsetY + j, x - offsetX + i));
-				maxV = std::max(maxV, currentV);
+				std::fill(minV.begin(), minV.end(), 1.0);
+				erodeRow(inputImage, B, I, w, y, minV.data());
+
+				Pixel* r = R[y];
+				for (int x = w.startX; x < w.endX; x++)
+					r[x] = static_cast<Pixel>(minV[x]);
 			}
 		}
 
-		return maxV;
-	}
+	private:
+		const cv::Mat_<Pixel>& inputImage;
+		const cv::Mat_<double>& B;
+		const Implication& I;
+		cv::Mat_<Pixel>& R;
+		Window w;
+	};
 
-	static inline double f_erode_local(const cv::Mat_<double>& inputImage,
-				const cv::Mat_<double>& B, unsigned int x, unsigned int y,
-				const FuzzyImplication& I)
+	template<typename Pixel, class Conjunction>
+	class DilateBody: public cv::ParallelLoopBody
 	{
-		double minV = 1.0;
+	public:
+		DilateBody(const cv::Mat_<Pixel>& inputImage, const cv::Mat_<double>& B,
+					const Conjunction& T, cv::Mat_<Pixel>& R) :
+					inputImage(inputImage), B(B), T(T), R(R),
+					w(inputImage.size(), B.size())
+		{
+		}
 
-		cv::Size seSize = B.size();
+		virtual void operator()(const cv::Range& rows) const
+		{
+			std::vector<double> maxV(inputImage.cols);
 
-		unsigned int offsetX = floor(seSize.width / 2);
-		unsigned int offsetY = floor(seSize.height / 2);
+			for (int y = rows.start; y < rows.end; y++)
+			{
+				std::fill(maxV.begin(), maxV.end(), 0.0);
+				dilateRow(inputImage, B, T, w, y, maxV.data());
 
-		for (unsigned int i = 0; i < seSize.width; i++)
+				Pixel* r = R[y];
+				for (int x = w.startX; x < w.endX; x++)
+					r[x] = static_cast<Pixel>(maxV[x]);
+			}
+		}
+
+	private:
+		const cv::Mat_<Pixel>& inputImage;
+		const cv::Mat_<double>& B;
+		const Conjunction& T;
+		cv::Mat_<Pixel>& R;
+		Window w;
+	};
+
+	template<typename Pixel, class Conjunction, class Implication>
+	class HomtBody: public cv::ParallelLoopBody
+	{
+	public:
+		HomtBody(const cv::Mat_<Pixel>& inputImage, const cv::Mat_<double>& Be,
+					const cv::Mat_<double>& Bd, const Conjunction& T,
+					const Implication& I, cv::Mat_<Pixel>& R) :
+					inputImage(inputImage), Be(Be), Bd(Bd), T(T), I(I), R(R),
+					w(inputImage.size(), Be.size())
 		{
-			for (unsigned int j = 0; j < seSize.height; j++)
+		}
+
+		virtual void operator()(const cv::Range& rows) const
+		{
+			std::vector<double> minVe(inputImage.cols);
+			std::vector<double> maxVd(inputImage.cols);
+
+			for (int y = rows.start; y < rows.end; y++)
 			{
-				double currentV = I(B(j, i),
-							inputImage(y - offsetY + j, x - offsetX + i));
-				minV = std::min(minV, currentV);
+				std::fill(minVe.begin(), minVe.end(), 1.0);
+				std::fill(maxVd.begin(), maxVd.end(), 0.0);
+				erodeRow(inputImage, Be, I, w, y, minVe.data());
+				dilateRow(inputImage, Bd, T, w, y, maxVd.data());
+
+				Pixel* r = R[y];
+				for (int x = w.startX; x < w.endX; x++)
+					r[x] = static_cast<Pixel>(T(minVe[x], 1 - maxVd[x]));
 			}
 		}
 
-		return minV;
-	}
+	private:
+		const cv::Mat_<Pixel>& inputImage;
+		const cv::Mat_<double>& Be;
+		const cv::Mat_<double>& Bd;
+		const Conjunction& T;
+		const Implication& I;
+		cv::Mat_<Pixel>& R;
+		Window w;
+	};
 
 };
 
@@ -35,33 +35,67 @@
 
 #include "ParameterServer.h"
 #include "AdvancedDetector.h"
+#include "DecodedImageCache.h"
 
 #include "ObjectClassificator.h"
 
 #include <map>
+#include <vector>
+#include <memory>
+#include <atomic>
+
+//detections of a track, waiting for the frame batch to be classified
+struct TrackDetections
+{
+	size_t id;
+	ros::Time t;
+	cv::Mat image;
+	cv::Mat mask;
+	DetectionArena* arena;
+	std::shared_ptr<ObjectClassificator> classificator;
+};
 
 class RecognizerLogic: public BaseLogic
 {
+	//runs the detectors of a range on the pending tracks
+	class DetectorBody: public cv::ParallelLoopBody
+	{
+	public:
+		DetectorBody(RecognizerLogic& logic,
+					std::vector<std::shared_ptr<TrackDetections> >& tracks,
+					std::atomic<size_t>& next);
+		virtual void operator()(const cv::Range& range) const;
+
+	private:
+		RecognizerLogic& logic;
+		std::vector<std::shared_ptr<TrackDetections> >& tracks;
+		std::atomic<size_t>& next;
+	};
+
 public:
 	RecognizerLogic(ros::NodeHandle n, ParameterServer& parameters);
+	~RecognizerLogic();
 	void handleCamera(const sensor_msgs::ImageConstPtr& msg,
 				const sensor_msgs::CameraInfoConstPtr& info_msg);
 	void handleTrack(const c_slam_msgs::TrackedObject& track);
+	void handleBatchTimeout(const ros::TimerEvent& event);
 
 private:
-	void detect(cv::Mat& image, cv::Mat& mask, bool showCanny);
-	void classify(image_geometry::PinholeCameraModel& cameraModel,
-				cv::Rect& roi, ros::Time t, size_t id);
-	void display(cv::Mat& image, unsigned int id);
+	void processPending();
+	void detectTracks(std::vector<std::shared_ptr<TrackDetections> >& tracks);
+	void runDetector(size_t worker,
+				std::vector<std::shared_ptr<TrackDetections> >& tracks,
+				std::atomic<size_t>& next);
+	void detect(AdvancedDetector& detector, TrackDetections& detections);
+	void classifyTracks(std::vector<std::shared_ptr<TrackDetections> >& tracks);
+	void display(TrackDetections& detections);
 
 	void rectify(ObjectClassificator& classificator,
 				image_geometry::PinholeCameraModel& cameraModel, cv::Rect& roi);
 
 private:
 	ros::Time getImageData(const c_slam_msgs::TrackedObject& track,
-				cv_bridge::CvImagePtr& cv_ptr,
-				cv_bridge::CvImagePtr& cv_ptr_color,
-				image_geometry::PinholeCameraModel& cameraModel);
+				cv::Mat& image, image_geometry::PinholeCameraModel& cameraModel);
 	void getRoi(const c_slam_msgs::TrackedObject& track, cv::Mat& input,
 				cv::Rect& roi, cv::Mat& image, cv::Mat& mask);
 
@@ -70,12 +104,20 @@ private:
 	image_transport::CameraSubscriber cameraSubscriber;
 
 	message_filters::Cache<sensor_msgs::CameraInfo> infoCache;
-	message_filters::Cache<sensor_msgs::Image> imageCache;
+	DecodedImageCache imageCache;
 
 	ros::Subscriber trackSubscriber;
 
-	//Object detection
-	AdvancedDetector detector;
+	//tracks of the same frame are classified with a single call
+	std::vector<std::shared_ptr<TrackDetections> > pendingTracks;
+	ros::Time pendingStamp;
+	ros::Timer batchTimer;
+
+	//Object detection, a detector for each worker
+	std::vector<AdvancedDetector*> detectors;
+
+	//detections of the tracks in flight
+	DetectionArenaPool arenas;
 
 	//Visualization
 	DisplayParam& dispP;
@@ -35,20 +35,10 @@ public:
 
 	void detect(cv::Mat& image, cv::Mat& mask, bool showCanny);
 
-	virtual void deleteDetections();
-
-	std::vector<Cluster>* getClusters() const
-	{
-		return clusters;
-	}
-
 private:
 	//detectors
 	ClusterDetector clusterDetector;
 
-	//last detections
-	std::vector<Cluster>* clusters;
-
 };
 
 
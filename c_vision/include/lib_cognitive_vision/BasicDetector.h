@@ -25,34 +25,53 @@
 #define BASICDETECTOR_H_
 
 #include "LineDetector.h"
+#include "EdgeSupport.h"
+#include "DetectionArena.h"
 
 #include <opencv2/core/core.hpp>
 
+class ProbQuadDetector;
 
 class BasicDetector
 {
 public:
 	BasicDetector(ParameterServer& parameters);
-	virtual void deleteDetections();
+	void resetDetections();
+	void swapDetections(DetectionArena& arena);
 
 	inline void setRoll(double roll)
 	{
 		this->roll = -roll;
 	}
 
-	std::vector<Pole>* getPoles() const
+	std::vector<Pole>* getPoles()
 	{
-		return poles;
+		return &detections.poles;
 	}
 
-	std::vector<Rectangle>* getRectangles() const
+	std::vector<Rectangle>* getRectangles()
 	{
-		return rectangles;
+		return &detections.rectangles;
 	}
 
-	std::vector<cv::Point>* getPoints() const
+	std::vector<cv::Point>* getPoints()
 	{
-		return points;
+		return &detections.points;
+	}
+
+	std::vector<Cluster>* getClusters()
+	{
+		return &detections.clusters;
+	}
+
+	std::vector<cv::Vec4i>* getVerticalLines()
+	{
+		return &detections.verticalLines;
+	}
+
+	std::vector<cv::Vec4i>* getHorizontalLines()
+	{
+		return &detections.horizontalLines;
 	}
 
 
@@ -65,6 +84,10 @@ protected:
 private:
 	//detectors and classifiers
 	LineDetector lineDetector;
+	ProbQuadDetector* quadDetector;
+
+	//edge queries on the current canny image
+	EdgeSupport edgeSupport;
 
 	//Parameter
 	QDetectorParam& quadParams;
@@ -76,12 +99,8 @@ private:
 	unsigned int height;
 
 protected:
-	std::vector<cv::Vec4i>* verticalLines;
-	std::vector<cv::Vec4i>* horizontalLines;
-
-	std::vector<Rectangle>* rectangles;
-	std::vector<Pole>* poles;
-	std::vector<cv::Point>* points;
+	//detections of the current frame, valid until the next reset
+	DetectionArena detections;
 };
 
 #endif /* BASICDETECTOR_H_ */
@@ -35,12 +35,17 @@ class ClusterDetector
 {
 public:
 	ClusterDetector(ClusterParam& params);
-	std::vector<Cluster>* detect(cv::Mat& input, const cv::Mat& mask = cv::Mat());
+	void detect(cv::Mat& input, std::vector<Cluster>& clusters,
+				const cv::Mat& mask = cv::Mat());
 
 private:
 	ClusterParam& params;
 	DBSCAN clustering;
 
+	//reused across frames
+	std::vector<cv::KeyPoint> keyPoints;
+	cv::Mat roi;
+
 };
 
 #endif /* FEATUREDETECTOR_H_ */
@@ -27,6 +27,7 @@
 #include <opencv2/opencv.hpp>
 
 #include "ParameterServer.h"
+#include "EdgeSupport.h"
 
 /**
  * x--N--x
@@ -85,7 +86,7 @@ class CornerClassifier
 {
 public:
 	CornerClassifier(CornerClassParam& params, const cv::Mat& canny,
-				double roll);
+				double roll, const EdgeSupport* edges = NULL);
 	CornerResult getResult(const cv::Point& point);
 private:
 	void computeHistogram(const cv::Point& point, cv::Mat& hist);
@@ -100,6 +101,7 @@ private:
 	double sinR;
 	double cosR;
 	const cv::Mat& canny;
+	const EdgeSupport* edges;
 
 private:
 	static const std::vector<cv::Mat> cornerPrototypes;
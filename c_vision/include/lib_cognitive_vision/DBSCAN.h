@@ -33,16 +33,31 @@ class DBSCAN
 {
 public:
 	DBSCAN(double& eps, int& minPts);
-	std::vector<Cluster>* detect(const std::vector<cv::KeyPoint>& keypoints);
+	void detect(const std::vector<cv::KeyPoint>& keypoints,
+				std::vector<Cluster>& clusters);
 
 private:
-	std::vector<int> listNeighbors(const std::vector<cv::KeyPoint>& keypoints,
-				const cv::KeyPoint &keypoint);
+	void buildGrid(const std::vector<cv::KeyPoint>& keypoints);
+	void listNeighbors(const std::vector<cv::KeyPoint>& keypoints, int index,
+				std::vector<int>& neighbors);
 
 private:
 	double& maxDistance;
 	int& minPoints;
 
+	//keypoints bucketed in square cells, reused across frames
+	std::vector<int> cellStart;
+	std::vector<int> cellPoints;
+	std::vector<int> pointCells;
+	int gridColumns;
+	int gridRows;
+	float cellSize;
+	float minX;
+	float minY;
+
+	//per point state
+	std::vector<char> visited;
+	std::vector<char> clustered;
 
 };
 
@@ -0,0 +1,125 @@
+/*
+ * c_vision,
+ *
+ *
+ * Copyright (C) 2014 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of c_vision.
+ *
+ * c_vision is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * c_vision is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with c_vision.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef INCLUDE_LIB_COGNITIVE_VISION_DETECTIONARENA_H_
+#define INCLUDE_LIB_COGNITIVE_VISION_DETECTIONARENA_H_
+
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <opencv2/core/core.hpp>
+
+#include "Rectangle.h"
+#include "Pole.h"
+#include "Cluster.h"
+
+/**
+ * Owns the detections of the current frame.
+ * The detectors fill these vectors, the callers get views of them.
+ * A reset empties every vector but keeps its storage for the next frame.
+ */
+struct DetectionArena
+{
+	void reset()
+	{
+		verticalLines.clear();
+		horizontalLines.clear();
+		rectangles.clear();
+		poles.clear();
+		points.clear();
+		clusters.clear();
+	}
+
+	//exchanges the storage, nothing is copied
+	void swap(DetectionArena& other)
+	{
+		verticalLines.swap(other.verticalLines);
+		horizontalLines.swap(other.horizontalLines);
+		rectangles.swap(other.rectangles);
+		poles.swap(other.poles);
+		points.swap(other.points);
+		clusters.swap(other.clusters);
+	}
+
+	std::vector<cv::Vec4i> verticalLines;
+	std::vector<cv::Vec4i> horizontalLines;
+	std::vector<Rectangle> rectangles;
+	std::vector<Pole> poles;
+	std::vector<cv::Point> points;
+	std::vector<Cluster> clusters;
+};
+
+/**
+ * Arenas of the frames waiting for their classification.
+ * A detector swaps its arena with a free one, so the detections of a frame
+ * move to the pool without a copy, and the storage comes back on release.
+ * The pool grows when every arena is in use, and never shrinks.
+ */
+class DetectionArenaPool
+{
+public:
+	DetectionArenaPool(int size)
+	{
+		for (int i = 0; i < std::max(size, 1); i++)
+			arenas.push_back(new DetectionArena());
+
+		freeArenas = arenas;
+	}
+
+	DetectionArena* acquire()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (freeArenas.empty())
+		{
+			arenas.push_back(new DetectionArena());
+			return arenas.back();
+		}
+
+		DetectionArena* arena = freeArenas.back();
+		freeArenas.pop_back();
+		return arena;
+	}
+
+	void release(DetectionArena* arena)
+	{
+		arena->reset();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		freeArenas.push_back(arena);
+	}
+
+	~DetectionArenaPool()
+	{
+		for (size_t i = 0; i < arenas.size(); i++)
+			delete arenas[i];
+	}
+
+private:
+	std::vector<DetectionArena*> arenas;
+	std::vector<DetectionArena*> freeArenas;
+	std::mutex mutex;
+};
+
+#endif /* INCLUDE_LIB_COGNITIVE_VISION_DETECTIONARENA_H_ */
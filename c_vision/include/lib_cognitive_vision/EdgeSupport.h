@@ -0,0 +1,71 @@
+/*
+ * c_vision,
+ *
+ *
+ * Copyright (C) 2014 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of c_vision.
+ *
+ * c_vision is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * c_vision is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with c_vision.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef INCLUDE_LIB_COGNITIVE_VISION_EDGESUPPORT_H_
+#define INCLUDE_LIB_COGNITIVE_VISION_EDGESUPPORT_H_
+
+#include <opencv2/core/core.hpp>
+
+/**
+ * Integral image of an edge map, built once per frame.
+ * Counts the edge pixels of any rectangle in constant time.
+ */
+class EdgeSupport
+{
+public:
+	void build(const cv::Mat& edges);
+
+	inline int count(int x, int y, int width, int height) const
+	{
+		const int* top = sum.ptr<int>(y);
+		const int* bottom = sum.ptr<int>(y + height);
+		return bottom[x + width] - bottom[x] - top[x + width] + top[x];
+	}
+
+	inline int count(const cv::Rect& roi) const
+	{
+		return count(roi.x, roi.y, roi.width, roi.height);
+	}
+
+	inline bool hasEdges(const cv::Rect& roi) const
+	{
+		return count(roi) > 0;
+	}
+
+	inline int getWidth() const
+	{
+		return binary.cols;
+	}
+
+	inline int getHeight() const
+	{
+		return binary.rows;
+	}
+
+private:
+	cv::Mat binary;
+	cv::Mat sum;
+};
+
+#endif /* INCLUDE_LIB_COGNITIVE_VISION_EDGESUPPORT_H_ */
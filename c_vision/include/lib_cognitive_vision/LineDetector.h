@@ -34,26 +34,23 @@ class LineDetector
 {
 public:
 	LineDetector(CannyParam& cannyP, HoughParam& houghP, LFilterParam& filterP);
-	void detect(cv::Mat& input, double roll, const cv::Mat& mask = cv::Mat());
+	void detect(cv::Mat& input, double roll,
+				std::vector<cv::Vec4i>& verticalLines,
+				std::vector<cv::Vec4i>& horizontalLines,
+				const cv::Mat& mask = cv::Mat());
 	void display();
 
-	std::vector<cv::Vec4i>* getVerticalLines()
-	{
-		return verticalLines;
-	}
-
-	std::vector<cv::Vec4i>* getHorizontalLines()
-	{
-		return horizontalLines;
-	}
-
 	const cv::Mat& getCanny()
 	{
 		return canny;
 	}
 
 private:
-	int computeThreshold(cv::Mat& src);
+	int computeThreshold(const cv::Mat& dx, const cv::Mat& dy);
+	void maskImage(cv::Mat& canny);
+
+private:
+	static std::vector<uchar> initMagnitudeTable();
 
 private:
 	CannyParam& cannyP;
@@ -64,7 +61,18 @@ private:
 	std::vector<cv::Vec4i>* verticalLines;
 	std::vector<cv::Vec4i>* horizontalLines;
 
-	void maskImage(cv::Mat& canny);
+	//preprocessing buffers, reallocated only when the resolution changes
+	cv::Mat blurred;
+	cv::Mat sharpened;
+	cv::Mat filtered;
+	cv::Mat dx;
+	cv::Mat dy;
+	cv::Mat edges;
+	std::vector<cv::Vec4i> lines;
+
+private:
+	//8 bit gradient magnitude of each saturated squared norm
+	static const std::vector<uchar> magnitudeTable;
 };
 
 #endif /* LINEDETECTOR_H_ */
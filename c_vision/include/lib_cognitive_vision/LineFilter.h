@@ -33,17 +33,9 @@ class LineFilter
 public:
 	LineFilter(LFilterParam& filterP);
 
-	void filter(std::vector<cv::Vec4i>& lines, double roll);
-
-	std::vector<cv::Vec4i>* getVerticalLines()
-	{
-		return verticalLines;
-	}
-
-	std::vector<cv::Vec4i>* getHorizontalLines()
-	{
-		return horizontalLines;
-	}
+	void filter(std::vector<cv::Vec4i>& lines, double roll,
+				std::vector<cv::Vec4i>& verticalLines,
+				std::vector<cv::Vec4i>& horizontalLines);
 
 private:
 	bool sameSlope(double line, double reference, double maxDelta);
@@ -52,9 +44,6 @@ private:
 	static bool isLeftmostLine(cv::Vec4i i, cv::Vec4i j);
 
 private:
-	std::vector<cv::Vec4i>* verticalLines;
-	std::vector<cv::Vec4i>* horizontalLines;
-
 	LFilterParam& filterP;
 };
 
@@ -29,6 +29,7 @@
 #include "ParameterServer.h"
 
 #include <c_fuzzy/Classification.h>
+#include <c_fuzzy/ClassificationGroup.h>
 #include <string>
 #include <vector>
 
@@ -37,8 +38,11 @@ class ObjectClassificator
 public:
 	ObjectClassificator(c_fuzzy::Classification& classification,
 				ClassifierParam& params);
+	ObjectClassificator(c_fuzzy::ClassificationGroup& group,
+				ClassifierParam& params);
 
 	void labelFeatures();
+	void labelFeatures(std::vector<c_fuzzy::ObjectClassification>& results);
 
 	std::vector<std::pair<std::vector<cv::Point>, std::string> > getGoodFeatures();
 
@@ -72,7 +76,7 @@ private:
 	void addFeature(Feature& feature);
 
 private:
-	c_fuzzy::Classification& classification;
+	std::vector<c_fuzzy::ObjectClassification>* results;
 	std::vector<c_fuzzy::InputObject>& objects;
 	std::vector<c_fuzzy::InputVariable>* currentVars;
 	std::map<size_t, Feature*> featureMap;
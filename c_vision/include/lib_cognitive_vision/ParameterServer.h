@@ -53,6 +53,14 @@ struct LFilterParam
 	double maxDeltaHorizontal;
 };
 
+enum SamplingStrategy
+{
+	UNIFORM_SAMPLING = 0,
+	HALTON_SAMPLING,
+	STRATIFIED_SAMPLING,
+	EDGE_SAMPLING
+};
+
 struct QDetectorParam
 {
 	//ROMANONI params
@@ -60,6 +68,9 @@ struct QDetectorParam
 	double threshold;
 	double maxDistance;
 	int minPoints;
+	int seed;
+	int threads;
+	SamplingStrategy sampling;
 
 	Eigen::Matrix3d K;
 	Eigen::Matrix3d omega;
@@ -81,6 +92,19 @@ struct ClusterParam
 struct ClassifierParam
 {
 	double threshold;
+	int topK;
+
+	//asynchronous client limits
+	int maxInFlight;
+	double deadline;
+
+	//load the classifier in the node instead of calling the service
+	bool inProcess;
+	std::string knowledgeBase;
+	std::string rules;
+
+	//use the packed messages with the remote classifier
+	bool compact;
 };
 
 struct DisplayParam
@@ -144,6 +168,16 @@ public:
 		return imu_source;
 	}
 
+	inline int getRecognizerWorkers()
+	{
+		return recognizerWorkers;
+	}
+
+	inline size_t getImageCacheBudget()
+	{
+		return imageCacheBudget;
+	}
+
 private:
 	void update(c_vision::ParametersConfig &config, uint32_t level);
 
@@ -163,6 +197,8 @@ private:
 
 	std::string camera_source;
 	std::string imu_source;
+	int recognizerWorkers;
+	size_t imageCacheBudget;
 
 };
 
@@ -32,25 +32,86 @@
 
 #include "Rectangle.h"
 #include "Pole.h"
+#include "EdgeSupport.h"
 
+#include <cstdint>
 #include <random>
+#include <unordered_map>
 
 class ProbQuadDetector
 {
-	template<int N, typename type>
-	struct vote_s
+	//votes of a line quadruple
+	struct VoteCell
 	{
-		typedef std::map<unsigned int, typename vote_s<N-1, type>::t_multimap> t_multimap;
+		unsigned int hits;
+		unsigned int total;
 	};
 
-	template<typename type>
-	struct vote_s<1, type>
+	//random stream of a single sample, fixed by the frame seed and the sample
+	class SampleGenerator
 	{
-		typedef std::map<unsigned int, type> t_multimap;
+	public:
+		typedef uint64_t result_type;
+
+		SampleGenerator(uint64_t seed, uint64_t n) :
+					state(mix(seed + mix(n)))
+		{
+		}
+
+		static constexpr result_type min()
+		{
+			return 0;
+		}
+
+		static constexpr result_type max()
+		{
+			return UINT64_MAX;
+		}
+
+		inline result_type operator()()
+		{
+			state += 0x9E3779B97F4A7C15ULL;
+			return mix(state);
+		}
+
+	private:
+		//splitmix64 finalizer
+		static inline uint64_t mix(uint64_t z)
+		{
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			return z ^ (z >> 31);
+		}
+
+	private:
+		uint64_t state;
 	};
 
-	typedef vote_s<4, int>::t_multimap t_vote;
-	typedef vote_s<4, double>::t_multimap t_counter;
+	//sampling state private to a thread
+	struct SampleWorker
+	{
+		std::vector<VoteCell> votes;
+		std::unordered_map<size_t, VoteCell> sparseVotes;
+		std::vector<size_t> touched;
+		std::vector<cv::Point> points;
+	};
+
+	//runs the sampling workers of a range
+	class SampleBody: public cv::ParallelLoopBody
+	{
+	public:
+		SampleBody(ProbQuadDetector& detector,
+					std::vector<cv::Vec4i>& verticalLines,
+					std::vector<cv::Vec4i>& horizontalLines,
+					const EdgeSupport& edges);
+		virtual void operator()(const cv::Range& range) const;
+
+	private:
+		ProbQuadDetector& detector;
+		std::vector<cv::Vec4i>& verticalLines;
+		std::vector<cv::Vec4i>& horizontalLines;
+		const EdgeSupport& edges;
+	};
 
 
 public:
@@ -58,50 +119,71 @@ public:
 
 	void detect(std::vector<cv::Vec4i>& verticalLines,
 				std::vector<cv::Vec4i>& horizontalLines,
-				const cv::Mat& canny);
-
-	inline std::vector<Pole>* getPoles() const
-	{
-		return poles;
-	}
-
-	inline std::vector<Rectangle>* getRectangles() const
-	{
-		return rectangles;
-	}
-
-	//TODO remove
-	inline std::vector<cv::Point>* getPoints() const
-	{
-		return points;
-	}
+				const EdgeSupport& edges, std::vector<Rectangle>& rectangles,
+				std::vector<cv::Point>& points);
 
 private:
-	unsigned int sampleCoordinate(unsigned int lo, unsigned int hi);
-	void buildRectangle(cv::Vec4i& v1, cv::Vec4i& v2, cv::Vec4i& h1, cv::Vec4i& h2);
-	void voteRectangles(unsigned int x, unsigned int y,
+	unsigned int sampleCoordinate(unsigned int lo, unsigned int hi,
+				SampleGenerator& gen);
+	void prepareWorkers(size_t verticalCount, size_t horizontalCount);
+	void prepareSampling(const EdgeSupport& edges);
+	cv::Point samplePoint(int n, const EdgeSupport& edges);
+	void sample(SampleWorker& worker, int begin, int samples,
+				std::vector<cv::Vec4i>& verticalLines,
+				std::vector<cv::Vec4i>& horizontalLines,
+				const EdgeSupport& edges);
+	VoteCell& getCell(SampleWorker& worker, size_t index);
+	void reduceVotes();
+	void buildLineIndex(std::vector<cv::Vec4i>& verticalLines,
+				std::vector<cv::Vec4i>& horizontalLines, unsigned int width);
+	void voteCell(SampleWorker& worker, size_t i, size_t k1, size_t j,
+				size_t k2, bool ok);
+	void buildRectangle(cv::Vec4i& v1, cv::Vec4i& v2, cv::Vec4i& h1,
+				cv::Vec4i& h2, std::vector<Rectangle>& rectangles);
+	void voteRectangles(SampleWorker& worker, unsigned int x, unsigned int y,
 				std::vector<cv::Vec4i>& verticalLines,
 				std::vector<cv::Vec4i>& horizontalLines,
-				const cv::Mat& canny);
+				const EdgeSupport& edges);
 
 	bool crispScore(unsigned int x, unsigned int y, cv::Vec4i& h1,
-				cv::Vec4i& h2, cv::Vec4i& v1, cv::Vec4i& v2, const cv::Mat& canny);
+				cv::Vec4i& h2, cv::Vec4i& v1, cv::Vec4i& v2,
+				const EdgeSupport& edges);
 	double fuzzyScore(unsigned int x, unsigned int y, cv::Vec4i& h1,
 					cv::Vec4i& h2, cv::Vec4i& v1, cv::Vec4i& v2);
 
 private:
-	std::vector<Rectangle>* rectangles;
-	std::vector<Pole>* poles;
-	std::vector<cv::Point>* points;
-
-	t_vote votes;
-	t_counter counts;
+	//accumulators indexed by (i, k1 - i - 1, j, k2), reused across frames
+	std::vector<SampleWorker> workers;
+	size_t horizontalCount;
+
+	//above this many cells for all the workers, the votes go in hash maps
+	bool denseVotes;
+	static constexpr size_t MAX_DENSE_CELLS = 1 << 20;
+
+	//vertical line pairs bucketed by the x range between them
+	std::vector<std::vector<std::pair<size_t, size_t> > > pairBuckets;
+	static constexpr unsigned int BUCKET_WIDTH = 16;
+
+	//horizontal lines sorted by their lowest and highest y
+	std::vector<std::pair<unsigned int, size_t> > aboveLines;
+	std::vector<std::pair<unsigned int, size_t> > belowLines;
+
+	//sampling strategies state
+	uint64_t frameSeed;
+	double haltonShift[2];
+	int gridColumns;
+	int gridRows;
+	std::vector<unsigned int> blockWeights;
+	int blockColumns;
+	static constexpr int BLOCK_SIZE = 16;
 
 	QDetectorParam& quadP;
 
-	//RANDOM STUFF
-	static std::random_device rd;
-	static std::mt19937 gen;
+	//seeds the frames when no seed is given, one per detector
+	std::random_device rd;
+
+private:
+	static double radicalInverse(unsigned int n, unsigned int base);
 };
 
 #endif /* INCLUDE_PROBQUADDETECTOR_H_ */
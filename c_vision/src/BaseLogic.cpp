@@ -36,7 +36,30 @@ BaseLogic::BaseLogic(ros::NodeHandle& n, ParameterServer& parameters) :
 {
 	imuSubscriber = n.subscribe(parameters.getImuSource() + "/imu", 1, &BaseLogic::handleImu, this);
 
-	connectToClassificationServer();
+	codec = NULL;
+
+	if (classifierParam.inProcess)
+	{
+		engine = new ClassificationEngine(classifierParam.knowledgeBase,
+					classifierParam.rules);
+	}
+	else
+	{
+		engine = NULL;
+		connectToClassificationServer();
+	}
+
+	classificationClient = new ClassificationClient(
+				[this](c_fuzzy::Classification& serviceCall, double timeout)
+				{
+					return classify(serviceCall, timeout);
+				}, classifierParam.maxInFlight, classifierParam.deadline);
+
+	batchClassificationClient = new BatchClassificationClient(
+				[this](c_fuzzy::BatchClassification& serviceCall, double timeout)
+				{
+					return classify(serviceCall, timeout);
+				}, classifierParam.maxInFlight, classifierParam.deadline);
 
 	roll = 0;
 	R = cv::Mat::eye(2, 2, CV_64F);
@@ -77,20 +100,146 @@ void BaseLogic::connectToClassificationServer()
 {
 	classificationService = n.serviceClient<c_fuzzy::Classification>(
 				"classification", true);
+	batchClassificationService = n.serviceClient<
+				c_fuzzy::BatchClassification>("batchClassification", true);
+	compactClassificationService = n.serviceClient<
+				c_fuzzy::CompactClassification>("compactClassification", true);
+	schemaService = n.serviceClient<c_fuzzy::ClassificationSchema>(
+				"getClassificationSchema");
 }
 
-void BaseLogic::callClassificationService(c_fuzzy::Classification& serviceCall)
+void BaseLogic::callClassificationService(
+			const shared_ptr<c_fuzzy::Classification>& serviceCall,
+			const ClassificationClient::Completion& completion)
 {
-	if (classificationService.isValid())
+	classificationClient->setLimits(classifierParam.maxInFlight,
+				classifierParam.deadline);
+	classificationClient->call(serviceCall, completion);
+}
+
+void BaseLogic::callBatchClassificationService(
+			const shared_ptr<c_fuzzy::BatchClassification>& serviceCall,
+			const BatchClassificationClient::Completion& completion)
+{
+	batchClassificationClient->setLimits(classifierParam.maxInFlight,
+				classifierParam.deadline);
+	batchClassificationClient->call(serviceCall, completion);
+}
+
+bool BaseLogic::classify(c_fuzzy::Classification& serviceCall, double timeout)
+{
+	if (engine)
 	{
-		classificationService.call(serviceCall);
+		lock_guard<mutex> lock(engineMutex);
+		engine->classify(serviceCall.request, serviceCall.response);
+		return true;
 	}
-	else
+
+	if (classifierParam.compact)
 	{
-		ROS_ERROR("Service down, waiting reconnection...");
-		classificationService.waitForExistence();
-		connectToClassificationServer();
+		lock_guard<mutex> lock(compactMutex);
+		if (!loadSchema(timeout))
+			return false;
+
+		c_fuzzy::Classification::Request& request = serviceCall.request;
+		c_fuzzy::CompactClassification compactCall;
+		compactCall.request.bypassCache = request.bypassCache;
+		compactCall.request.schemaVersion = codec->getVersion();
+		compactCall.request.groups.resize(1);
+		codec->encode(request.threshold, request.topK, request.objects,
+					compactCall.request.groups[0]);
+
+		if (!callService(compactClassificationService, compactCall, timeout)
+					|| compactCall.response.results.size() != 1
+					|| !codec->decode(compactCall.response.results[0],
+								serviceCall.response.results))
+		{
+			resetSchema();
+			return false;
+		}
+
+		return true;
 	}
+
+	return callService(classificationService, serviceCall, timeout);
+}
+
+bool BaseLogic::classify(c_fuzzy::BatchClassification& serviceCall,
+			double timeout)
+{
+	if (engine)
+	{
+		lock_guard<mutex> lock(engineMutex);
+		engine->classify(serviceCall.request, serviceCall.response);
+		return true;
+	}
+
+	if (classifierParam.compact)
+	{
+		lock_guard<mutex> lock(compactMutex);
+		if (!loadSchema(timeout))
+			return false;
+
+		vector<c_fuzzy::ClassificationGroup>& groups =
+					serviceCall.request.groups;
+		c_fuzzy::CompactClassification compactCall;
+		compactCall.request.bypassCache = serviceCall.request.bypassCache;
+		compactCall.request.schemaVersion = codec->getVersion();
+		compactCall.request.groups.resize(groups.size());
+		for (size_t i = 0; i < groups.size(); i++)
+		{
+			c_fuzzy::CompactGroup& group = compactCall.request.groups[i];
+			group.id = groups[i].id;
+			codec->encode(groups[i].threshold, groups[i].topK,
+						groups[i].objects, group);
+		}
+
+		vector<c_fuzzy::CompactGroupOutput>& outputs =
+					compactCall.response.results;
+		if (!callService(compactClassificationService, compactCall, timeout)
+					|| outputs.size() != groups.size())
+		{
+			resetSchema();
+			return false;
+		}
+
+		serviceCall.response.results.resize(outputs.size());
+		for (size_t i = 0; i < outputs.size(); i++)
+		{
+			c_fuzzy::GroupClassification& result = serviceCall.response.results[i];
+			result.id = outputs[i].id;
+			if (!codec->decode(outputs[i], result.results))
+			{
+				resetSchema();
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	return callService(batchClassificationService, serviceCall,
+				timeout);
+}
+
+bool BaseLogic::loadSchema(double timeout)
+{
+	if (codec)
+		return true;
+
+	c_fuzzy::ClassificationSchema schemaCall;
+	if (!callService(schemaService, schemaCall, timeout))
+		return false;
+
+	codec = new CompactCodec(schemaCall.response);
+	return true;
+}
+
+void BaseLogic::resetSchema()
+{
+	//the server may have been restarted with another knowledge base
+	delete codec;
+	codec = NULL;
 }
 
 void BaseLogic::sendFeatures(
@@ -122,3 +271,11 @@ void BaseLogic::sendFeatures(
 	}
 }
 
+BaseLogic::~BaseLogic()
+{
+	//stop the workers before the engine goes away
+	delete classificationClient;
+	delete batchClassificationClient;
+	delete engine;
+	delete codec;
+}
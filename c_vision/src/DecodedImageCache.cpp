@@ -0,0 +1,98 @@
+/*
+ * c_vision,
+ *
+ *
+ * Copyright (C) 2014 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of c_vision.
+ *
+ * c_vision is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * c_vision is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with c_vision.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "DecodedImageCache.h"
+
+#include <cv_bridge/cv_bridge.h>
+#include <sensor_msgs/image_encodings.h>
+
+using namespace std;
+
+namespace enc = sensor_msgs::image_encodings;
+
+DecodedImageCache::DecodedImageCache(size_t budget) :
+			budget(budget), bytes(0)
+{
+}
+
+void DecodedImageCache::add(const sensor_msgs::ImageConstPtr& msg)
+{
+	Entry& entry = frames[msg->header.stamp];
+	bytes -= entry.bytes;
+
+	entry.msg = msg;
+	entry.image.release();
+	entry.bytes = msg->data.size();
+	bytes += entry.bytes;
+
+	evict();
+}
+
+bool DecodedImageCache::getElemBeforeTime(const ros::Time& t, cv::Mat& image,
+			ros::Time& stamp)
+{
+	//the last frame not after t
+	map<ros::Time, Entry>::iterator it = frames.upper_bound(t);
+
+	if (it == frames.begin())
+		return false;
+
+	--it;
+
+	bool decoded = it->second.image.empty();
+
+	if (decoded)
+		decode(it->second);
+
+	//the tracks share the decoded frame, it must not be modified
+	image = it->second.image;
+	stamp = it->first;
+
+	if (decoded)
+		evict();
+
+	return true;
+}
+
+void DecodedImageCache::decode(Entry& entry)
+{
+	entry.image = cv_bridge::toCvCopy(entry.msg, enc::BGR8)->image;
+
+	//the raw message is no longer needed
+	entry.msg.reset();
+
+	bytes -= entry.bytes;
+	entry.bytes = entry.image.total() * entry.image.elemSize();
+	bytes += entry.bytes;
+}
+
+void DecodedImageCache::evict()
+{
+	//drop the oldest frames, but always keep the newest one
+	while (bytes > budget && frames.size() > 1)
+	{
+		bytes -= frames.begin()->second.bytes;
+		frames.erase(frames.begin());
+	}
+}
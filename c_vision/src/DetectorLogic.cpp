@@ -34,7 +34,8 @@ using namespace std;
 using namespace cv;
 
 DetectorLogic::DetectorLogic(ros::NodeHandle& n, ParameterServer& parameters) :
-			BaseLogic(n, parameters), detector(parameters)
+			BaseLogic(n, parameters), detector(parameters),
+			arenas(classifierParam.maxInFlight)
 {
 	imageSubscriber = it.subscribe(parameters.getCameraSource() + "/image_rect_color", 1,
 				&DetectorLogic::handleImage, this);
@@ -54,8 +55,8 @@ void DetectorLogic::handleImage(const sensor_msgs::ImageConstPtr& msg)
 		cv_ptr = cv_bridge::toCvCopy(msg, enc::BGR8);
 
 		detect(cv_ptr);
-		classify(msg->header.stamp);
-		display(cv_ptr);
+		classify(cv_ptr, msg->header.stamp);
+		detector.resetDetections();
 
 	}
 	catch (cv_bridge::Exception& e)
@@ -70,39 +71,51 @@ void DetectorLogic::detect(const cv_bridge::CvImagePtr& cv_ptr)
 	detector.detect(cv_ptr->image);
 }
 
-void DetectorLogic::classify(ros::Time t)
+void DetectorLogic::classify(const cv_bridge::CvImagePtr& cv_ptr, ros::Time t)
 {
-	c_fuzzy::Classification serviceCall;
-
-	ObjectClassificator classificator(serviceCall, classifierParam);
-	classificator.processFeatures(detector.getRectangles(), R);
-
-	callClassificationService(serviceCall);
-
-	classificator.labelFeatures();
-
-	const vector<pair<vector<Point>, string> >& features =
-				classificator.getGoodFeatures();
-
-	sendFeatures(features, t);
-
+	shared_ptr<FrameDetections> frame(new FrameDetections());
+	frame->t = t;
+	frame->image = cv_ptr->image;
+	frame->arena = arenas.acquire();
+	detector.swapDetections(*frame->arena);
+
+	shared_ptr<c_fuzzy::Classification> serviceCall(
+				new c_fuzzy::Classification());
+	shared_ptr<ObjectClassificator> classificator(
+				new ObjectClassificator(*serviceCall, classifierParam));
+	classificator->processFeatures(&frame->arena->rectangles, R);
+
+	//the next frame is detected while this one is classified
+	callClassificationService(serviceCall,
+				[=](c_fuzzy::Classification& call, bool success)
+				{
+					if (success)
+					{
+						classificator->labelFeatures();
+						sendFeatures(classificator->getGoodFeatures(), frame->t);
+					}
+
+					display(*frame);
+					arenas.release(frame->arena);
+				});
 }
 
-void DetectorLogic::display(const cv_bridge::CvImagePtr& cv_ptr)
+void DetectorLogic::display(FrameDetections& frame)
 {
 	ImageView& view1 = ViewerManager::getInstance().getView("Detection");
 	ImageView& view2 = ViewerManager::getInstance().getView("Canny");
 
-	view1.setRectangles(detector.getRectangles());
-	view1.setPoles(detector.getPoles());
+	DetectionArena& arena = *frame.arena;
+
+	view1.setRectangles(&arena.rectangles);
+	view1.setPoles(&arena.poles);
 	view1.setRoll(roll);
-	view1.setImage(cv_ptr->image);
+	view1.setImage(frame.image);
 
-	view2.setPoints(detector.getPoints());
+	view2.setPoints(&arena.points);
+	view2.setVerticalLines(&arena.verticalLines);
+	view2.setHorizontalLines(&arena.horizontalLines);
 
 	view1.display();
 	view2.display();
-
-	detector.deleteDetections();
 }
-
@@ -0,0 +1,155 @@
+/*
+ * c_vision,
+ *
+ *
+ * Copyright (C) 2014 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of c_vision.
+ *
+ * c_vision is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * c_vision is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with c_vision.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ProbQuadDetector.h"
+#include "EdgeSupport.h"
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace cv;
+using namespace std;
+
+//synthetic edge map with rectangles of decreasing size and some clutter
+void buildScene(Mat& canny, vector<Vec4i>& verticalLines,
+			vector<Vec4i>& horizontalLines, vector<Rect>& truth)
+{
+	canny = Mat::zeros(480, 640, CV_8UC1);
+
+	truth.push_back(Rect(40, 60, 200, 300));
+	truth.push_back(Rect(280, 100, 120, 160));
+	truth.push_back(Rect(440, 150, 60, 80));
+	truth.push_back(Rect(540, 200, 30, 40));
+
+	for (auto& r : truth)
+	{
+		rectangle(canny, r, Scalar(255));
+
+		int x1 = r.x + r.width;
+		int y1 = r.y + r.height;
+		verticalLines.push_back(Vec4i(r.x, r.y, r.x, y1));
+		verticalLines.push_back(Vec4i(x1, r.y, x1, y1));
+		horizontalLines.push_back(Vec4i(r.x, r.y, x1, r.y));
+		horizontalLines.push_back(Vec4i(r.x, y1, x1, y1));
+	}
+
+	RNG rng(42);
+	for (int n = 0; n < 2000; n++)
+		canny.at<uchar>(rng.uniform(0, canny.rows), rng.uniform(0, canny.cols)) = 255;
+
+	//the line detector returns lines sorted by position
+	sort(horizontalLines.begin(), horizontalLines.end(),
+				[](const Vec4i& a, const Vec4i& b)
+				{	return a[1] < b[1];});
+}
+
+int countFound(vector<Rectangle>& rectangles, vector<Rect>& truth)
+{
+	int found = 0;
+
+	for (auto& r : truth)
+	{
+		Point center(r.x + r.width / 2, r.y + r.height / 2);
+
+		for (auto& rectangle : rectangles)
+		{
+			Point d = rectangle.getCenter() - center;
+			if (d.dot(d) <= 25)
+			{
+				found++;
+				break;
+			}
+		}
+	}
+
+	return found;
+}
+
+int main()
+{
+	const int trials = 50;
+	const int sampleCounts[] = { 50, 100, 200, 400, 800 };
+	const char* names[] = { "uniform", "halton", "stratified", "edge" };
+
+	Mat canny;
+	vector<Vec4i> verticalLines;
+	vector<Vec4i> horizontalLines;
+	vector<Rect> truth;
+	buildScene(canny, verticalLines, horizontalLines, truth);
+
+	EdgeSupport edges;
+	edges.build(canny);
+
+	QDetectorParam params;
+	params.threshold = 0.9;
+	params.maxDistance = 30.0;
+	params.minPoints = 5;
+	params.threads = 1;
+	params.K = Eigen::Matrix3d::Identity();
+	params.omega = Eigen::Matrix3d::Identity();
+
+	vector<Rectangle> rectangles;
+	vector<Point> points;
+
+	cout << setw(12) << "strategy" << setw(10) << "samples" << setw(10)
+				<< "recall" << setw(12) << "detections" << endl;
+
+	for (int strategy = UNIFORM_SAMPLING; strategy <= EDGE_SAMPLING; strategy++)
+	{
+		params.sampling = static_cast<SamplingStrategy>(strategy);
+
+		for (int samples : sampleCounts)
+		{
+			params.points = samples;
+
+			double found = 0;
+			double detections = 0;
+
+			for (int trial = 0; trial < trials; trial++)
+			{
+				params.seed = trial + 1;
+
+				ProbQuadDetector detector(params);
+				detector.detect(verticalLines, horizontalLines, edges,
+							rectangles, points);
+
+				found += countFound(rectangles, truth);
+				detections += rectangles.size();
+
+				rectangles.clear();
+				points.clear();
+			}
+
+			cout << setw(12) << names[strategy] << setw(10) << samples
+						<< setw(10) << fixed << setprecision(3)
+						<< found / (trials * truth.size()) << setw(12)
+						<< setprecision(2) << detections / trials << endl;
+		}
+	}
+
+	return 0;
+}
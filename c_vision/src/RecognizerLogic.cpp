@@ -30,6 +30,8 @@
 
 #include "ViewerManager.h"
 
+#include <algorithm>
+
 using namespace ros;
 using namespace sensor_msgs;
 using namespace image_geometry;
@@ -40,14 +42,21 @@ using namespace std;
 namespace enc = sensor_msgs::image_encodings;
 
 RecognizerLogic::RecognizerLogic(NodeHandle n, ParameterServer& parameters) :
-			BaseLogic(n, parameters), infoCache(15), imageCache(15),
-			detector(parameters), dispP(parameters.getDisplayParams())
+			BaseLogic(n, parameters), infoCache(15),
+			imageCache(parameters.getImageCacheBudget()),
+			arenas(classifierParam.maxInFlight),
+			dispP(parameters.getDisplayParams())
 {
+	for (int i = 0; i < parameters.getRecognizerWorkers(); i++)
+		detectors.push_back(new AdvancedDetector(parameters));
+
 	cameraSubscriber = it.subscribeCamera(parameters.getCameraSource() + "/image_rect_color", 1,
 				&RecognizerLogic::handleCamera, this);
 	trackSubscriber = n.subscribe("tracks", 10, &RecognizerLogic::handleTrack,
 				this);
 	publisher = n.advertise<c_slam_msgs::NamedPolygon>("objects", 10);
+	batchTimer = n.createTimer(ros::Duration(0.1),
+				&RecognizerLogic::handleBatchTimeout, this, true, false);
 }
 
 void RecognizerLogic::handleCamera(const ImageConstPtr& msg,
@@ -60,19 +69,28 @@ void RecognizerLogic::handleCamera(const ImageConstPtr& msg,
 
 void RecognizerLogic::handleTrack(const c_slam_msgs::TrackedObject& track)
 {
-	Mat objectImage, mask;
+	Mat frame, objectImage, mask;
 	Rect roi;
-	CvImagePtr cv_ptr, cv_ptr_color;
 	PinholeCameraModel cameraModel;
 
+	//a new frame is starting, process the tracks of the previous one
+	if (!pendingTracks.empty() && track.imageStamp != pendingStamp)
+		processPending();
+
 	try
 	{
-		ros::Time t = getImageData(track, cv_ptr, cv_ptr_color, cameraModel);
-		getRoi(track, cv_ptr_color->image, roi, objectImage, mask);
-		detect(objectImage, mask, track.id == dispP.currentObject);
-		classify(cameraModel, roi, t, track.id);
-		display(objectImage, track.id);
-		detector.deleteDetections();
+		ros::Time t = getImageData(track, frame, cameraModel);
+		getRoi(track, frame, roi, objectImage, mask);
+
+		shared_ptr<TrackDetections> detections(new TrackDetections());
+		detections->id = track.id;
+		detections->t = t;
+		detections->image = objectImage;
+		detections->mask = mask;
+		detections->arena = NULL;
+
+		pendingTracks.push_back(detections);
+		pendingStamp = track.imageStamp;
 	}
 	catch (cv_bridge::Exception& e)
 	{
@@ -82,43 +100,145 @@ void RecognizerLogic::handleTrack(const c_slam_msgs::TrackedObject& track)
 	{
 		ROS_WARN(e.what());
 	}
+
+	//the last frame is classified even if no other track arrives
+	batchTimer.stop();
+	batchTimer.start();
+}
+
+void RecognizerLogic::handleBatchTimeout(const ros::TimerEvent& event)
+{
+	if (!pendingTracks.empty())
+		processPending();
 }
 
-void RecognizerLogic::detect(Mat& image, Mat& mask, bool showCanny)
+void RecognizerLogic::processPending()
 {
-	Mat greyFrame;
+	vector<shared_ptr<TrackDetections> > tracks;
+	tracks.swap(pendingTracks);
 
-	detector.setRoll(roll);
-	detector.detect(image, mask, showCanny);
+	//the frames are classified, and published, in stamp order
+	detectTracks(tracks);
+	classifyTracks(tracks);
+}
+
+void RecognizerLogic::detectTracks(vector<shared_ptr<TrackDetections> >& tracks)
+{
+	atomic<size_t> next(0);
+
+	//the displayed track shows its canny image, so it is detected on this thread
+	auto displayed = find_if(tracks.begin(), tracks.end(),
+				[&](const shared_ptr<TrackDetections>& detections)
+				{	return detections->id == dispP.currentObject;});
+
+	if (displayed != tracks.end())
+	{
+		iter_swap(tracks.begin(), displayed);
+		detect(*detectors[0], *tracks[0]);
+		next++;
+	}
+
+	//one stripe per detector, the OpenCV pool runs them
+	size_t count = min(detectors.size(), tracks.size() - next);
+	if (count > 0)
+	{
+		DetectorBody body(*this, tracks, next);
+		parallel_for_(Range(0, count), body, count);
+	}
+}
+
+RecognizerLogic::DetectorBody::DetectorBody(RecognizerLogic& logic,
+			vector<shared_ptr<TrackDetections> >& tracks, atomic<size_t>& next) :
+			logic(logic), tracks(tracks), next(next)
+{
 }
 
-void RecognizerLogic::classify(PinholeCameraModel& cameraModel, Rect& roi, ros::Time t, size_t id)
+void RecognizerLogic::DetectorBody::operator()(const Range& range) const
 {
-	c_fuzzy::Classification serviceCall;
-	ObjectClassificator classificator(serviceCall, classifierParam);
-	classificator.processFeatures(detector.getRectangles(), R);
-	classificator.processFeatures(detector.getPoles(), R);
-	classificator.processFeatures(detector.getClusters(), R);
+	for (int w = range.start; w < range.end; w++)
+		logic.runDetector(w, tracks, next);
+}
 
-	callClassificationService(serviceCall);
+void RecognizerLogic::runDetector(size_t worker,
+			vector<shared_ptr<TrackDetections> >& tracks, atomic<size_t>& next)
+{
+	AdvancedDetector& detector = *detectors[worker];
 
-	classificator.labelFeatures();
-	const vector<pair<vector<Point>, string> >& features =
-				classificator.getGoodFeatures();
+	for (size_t i = next++; i < tracks.size(); i = next++)
+		detect(detector, *tracks[i]);
+}
 
-	sendFeatures(features, t, id);
+void RecognizerLogic::detect(AdvancedDetector& detector,
+			TrackDetections& detections)
+{
+	detector.setRoll(roll);
+	detector.detect(detections.image, detections.mask,
+				detections.id == dispP.currentObject);
 
+	detections.arena = arenas.acquire();
+	detector.swapDetections(*detections.arena);
 }
 
-void RecognizerLogic::display(Mat& image, unsigned int id)
+void RecognizerLogic::classifyTracks(
+			vector<shared_ptr<TrackDetections> >& tracks)
 {
-	if(id != dispP.currentObject)
+	shared_ptr<c_fuzzy::BatchClassification> serviceCall(
+				new c_fuzzy::BatchClassification());
+	vector<c_fuzzy::ClassificationGroup>& groups = serviceCall->request.groups;
+
+	groups.resize(tracks.size());
+	for (size_t i = 0; i < tracks.size(); i++)
+	{
+		TrackDetections& detections = *tracks[i];
+		groups[i].id = detections.id;
+
+		detections.classificator.reset(
+					new ObjectClassificator(groups[i], classifierParam));
+		DetectionArena& arena = *detections.arena;
+		detections.classificator->processFeatures(&arena.rectangles, R);
+		detections.classificator->processFeatures(&arena.poles, R);
+		detections.classificator->processFeatures(&arena.clusters, R);
+	}
+
+	//the next frame is detected while this one is classified
+	callBatchClassificationService(serviceCall,
+				[=](c_fuzzy::BatchClassification& call, bool success)
+				{
+					vector<c_fuzzy::GroupClassification>& results =
+								call.response.results;
+
+					for (size_t i = 0; i < tracks.size(); i++)
+					{
+						TrackDetections& detections = *tracks[i];
+
+						if (success && i < results.size()
+									&& results[i].id == detections.id)
+						{
+							ObjectClassificator& classificator =
+										*detections.classificator;
+							classificator.labelFeatures(results[i].results);
+							sendFeatures(classificator.getGoodFeatures(),
+										detections.t, detections.id);
+						}
+
+						display(detections);
+						arenas.release(detections.arena);
+						detections.arena = NULL;
+					}
+				});
+}
+
+void RecognizerLogic::display(TrackDetections& detections)
+{
+	if(detections.id != dispP.currentObject)
 		return;
 
-	ImageView& viewer = ViewerManager::getInstance().getView(id);
-	viewer.setRectangles(detector.getRectangles());
-	viewer.setPoles(detector.getPoles());
-	viewer.setClusters(detector.getClusters());
+	Mat& image = detections.image;
+	ImageView& viewer = ViewerManager::getInstance().getView(detections.id);
+	DetectionArena& arena = *detections.arena;
+	viewer.setRectangles(&arena.rectangles);
+	viewer.setPoles(&arena.poles);
+	viewer.setClusters(&arena.clusters);
 	viewer.setRoll(roll);
 
 	cv::Mat bigImage(360, 640, CV_8UC3, cv::Scalar(0,0,0));
@@ -131,23 +251,18 @@ void RecognizerLogic::display(Mat& image, unsigned int id)
 }
 
 ros::Time RecognizerLogic::getImageData(const c_slam_msgs::TrackedObject& track,
-			CvImagePtr& cv_ptr, CvImagePtr& cv_ptr_color,
-			PinholeCameraModel& cameraModel)
+			Mat& image, PinholeCameraModel& cameraModel)
 {
 	Time t = track.imageStamp + Duration(0, 100);
-	const ImageConstPtr& img = imageCache.getElemBeforeTime(t);
+	Time stamp;
 	const CameraInfoConstPtr& info_msg = infoCache.getElemBeforeTime(t);
 
-
-	if (img == NULL || info_msg == NULL)
+	if (info_msg == NULL || !imageCache.getElemBeforeTime(t, image, stamp))
 		throw runtime_error("No valid image/info pairs in cache");
 
 	cameraModel.fromCameraInfo(info_msg);
 
-	cv_ptr = toCvCopy(img, enc::MONO8);
-	cv_ptr_color = toCvCopy(img, enc::BGR8);
-
-	return img->header.stamp;
+	return stamp;
 }
 
 void RecognizerLogic::getRoi(const c_slam_msgs::TrackedObject& track,
@@ -175,3 +290,9 @@ void RecognizerLogic::getRoi(const c_slam_msgs::TrackedObject& track,
 	mask.setTo(0);
 	fillConvexPoly(mask, polygon, 255, 8, 0);
 }
+
+RecognizerLogic::~RecognizerLogic()
+{
+	for (auto detector : detectors)
+		delete detector;
+}
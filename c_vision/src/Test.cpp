@@ -23,8 +23,123 @@
 
 #include "FHOMT/FuzzyMorphologicalOperators.h"
 
+#include <iostream>
+#include <iomanip>
+
 using namespace cv;
 
+//milliseconds per call of an operator
+template<class Operation>
+double timeOperation(const Operation& operation, int iterations)
+{
+	int64 start = getTickCount();
+
+	for (int i = 0; i < iterations; i++)
+		operation();
+
+	return (getTickCount() - start) * 1000.0 / getTickFrequency() / iterations;
+}
+
+template<typename Pixel>
+void benchmark(const Mat_<double>& image, const Mat_<double>& B,
+			const Mat_<double>& Bf, const char* name)
+{
+	const int iterations = 20;
+
+	Mat_<Pixel> input;
+	image.convertTo(input, DataType<Pixel>::type);
+
+	LukasiewiczConjunction T;
+	LukasiewiczImplication I;
+
+	double erode = timeOperation([&]()
+	{	MorphOp::f_erode(input, Bf, I);}, iterations);
+	double dilate = timeOperation([&]()
+	{	MorphOp::f_dilate(input, Bf, T);}, iterations);
+	double homt = timeOperation([&]()
+	{	MorphOp::f_homt(input, B, T, I);}, iterations);
+
+	std::cout << std::setw(8) << name << std::fixed << std::setprecision(2)
+				<< std::setw(12) << erode << std::setw(12) << dilate
+				<< std::setw(12) << homt << std::endl;
+}
+
+void benchmark()
+{
+	Mat_<double> image(480, 640);
+	randu(image, 0.0, 1.0);
+
+	Mat_<double> B(5, 5, -0.2);
+	B.col(2).setTo(1.0);
+
+	Mat_<double> Bf = max(0, B);
+
+	std::cout << "640x480 frame, 5x5 structuring element, ms per call"
+				<< std::endl;
+	std::cout << std::setw(8) << "type" << std::setw(12) << "erode"
+				<< std::setw(12) << "dilate" << std::setw(12) << "homt"
+				<< std::endl;
+
+	benchmark<double>(image, B, Bf, "double");
+	benchmark<float>(image, B, Bf, "float");
+
+	//the float kernels only round the output
+	Mat_<float> imageF;
+	image.convertTo(imageF, CV_32F);
+	LukasiewiczConjunction T;
+	LukasiewiczImplication I;
+	Mat R = MorphOp::f_homt(image, B, T, I);
+	Mat RF = MorphOp::f_homt(imageF, B, T, I);
+	RF.convertTo(RF, CV_64F);
+
+	std::cout << "max float difference: " << norm(R, RF, NORM_INF)
+				<< std::endl;
+}
+
+//flat square elements, with the running extrema and with the general kernel
+void benchmarkFlat()
+{
+	const int iterations = 5;
+
+	Mat_<float> image(480, 640);
+	randu(image, 0.0, 1.0);
+
+	MinimumConjunction T;
+	MinimumImplication I;
+
+	//through the base classes the general kernel is used
+	const FuzzyConjunction& Tg = T;
+	const FuzzyImplication& Ig = I;
+
+	std::cout << "640x480 float frame, flat square element, ms per call"
+				<< std::endl;
+	std::cout << std::setw(8) << "size" << std::setw(12) << "erode"
+				<< std::setw(12) << "dilate" << std::setw(12) << "general"
+				<< std::setw(12) << "difference" << std::endl;
+
+	for (int size = 3; size <= 31; size = 2 * size + 1)
+	{
+		Mat_<double> B(size, size, 0.8);
+
+		double erode = timeOperation([&]()
+		{	MorphOp::f_erode(image, B, I);}, iterations);
+		double dilate = timeOperation([&]()
+		{	MorphOp::f_dilate(image, B, T);}, iterations);
+		double general = timeOperation([&]()
+		{	MorphOp::f_dilate(image, B, Tg);}, iterations);
+
+		double difference = norm(MorphOp::f_dilate(image, B, T),
+					MorphOp::f_dilate(image, B, Tg), NORM_INF)
+					+ norm(MorphOp::f_erode(image, B, I),
+								MorphOp::f_erode(image, B, Ig), NORM_INF);
+
+		std::cout << std::setw(8) << size << std::fixed << std::setprecision(2)
+					<< std::setw(12) << erode << std::setw(12) << dilate
+					<< std::setw(12) << general << std::setw(12) << difference
+					<< std::endl;
+	}
+}
+
 int main()
 {
 	Mat_<double> A(8, 4);
@@ -76,5 +191,8 @@ int main()
 	std::cout << "Dc: " << std::endl << Dc << std::endl;
 	std::cout << "Df: " << std::endl << Df << std::endl;
 	std::cout << "R: "  << std::endl << R << std::endl;
+
+	benchmark();
+	benchmarkFlat();
 }
 
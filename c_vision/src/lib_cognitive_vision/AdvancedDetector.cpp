@@ -29,7 +29,6 @@ AdvancedDetector::AdvancedDetector(ParameterServer& parameters) :
 			BasicDetector(parameters),
 			clusterDetector(parameters.getDBScanParams())
 {
-	clusters = NULL;
 }
 
 void AdvancedDetector::detect(Mat& image, Mat& mask, bool showCanny)
@@ -44,16 +43,5 @@ void AdvancedDetector::detect(Mat& image, Mat& mask, bool showCanny)
 	detectQuadrilaterals(true);
 
 	//detect clusters
-	clusters = clusterDetector.detect(grayFrame, mask);
-}
-
-void AdvancedDetector::deleteDetections()
-{
-	if(clusters)
-	{
-		delete clusters;
-		clusters = NULL;
-	}
-
-	BasicDetector::deleteDetections();
+	clusterDetector.detect(grayFrame, detections.clusters, mask);
 }
@@ -44,53 +44,38 @@ BasicDetector::BasicDetector(ParameterServer& parameters) :
 			quadParams(parameters.getQuadDetectorParams()),
 			cornerParams(parameters.getCornerClassParams())
 {
-	horizontalLines = NULL;
-	verticalLines = NULL;
-	rectangles = NULL;
-	poles = NULL;
-	points = NULL;
 	roll = 0;
 	height = 0;
 	width = 0;
+
+#ifdef ROMANONI
+	quadDetector = new ProbQuadDetector(quadParams);
+#else
+	quadDetector = NULL;
+#endif
+}
+
+void BasicDetector::resetDetections()
+{
+	detections.reset();
 }
 
-void BasicDetector::deleteDetections()
+void BasicDetector::swapDetections(DetectionArena& arena)
 {
-	if (verticalLines && horizontalLines)
-	{
-		delete verticalLines;
-		delete horizontalLines;
-
-		verticalLines = NULL;
-		horizontalLines = NULL;
-	}
-
-	if (rectangles && poles)
-	{
-		delete rectangles;
-		delete poles;
-
-		rectangles = NULL;
-		poles = NULL;
-	}
-
-	if(points)
-	{
-		delete points;
-		points = NULL;
-	}
+	detections.swap(arena);
 }
 
 void BasicDetector::detectLines(Mat& image, const Mat& mask, bool showCanny)
 {
-	lineDetector.detect(image, roll, mask);
+	//drop what a failed frame may have left
+	detections.reset();
+
+	lineDetector.detect(image, roll, detections.verticalLines,
+				detections.horizontalLines, mask);
 
 	if (showCanny)
 		lineDetector.display();
 
-	verticalLines = lineDetector.getVerticalLines();
-	horizontalLines = lineDetector.getHorizontalLines();
-
 #ifdef ROMANONI
 	width = image.cols;
 	height = image.rows;
@@ -99,22 +84,31 @@ void BasicDetector::detectLines(Mat& image, const Mat& mask, bool showCanny)
 
 void BasicDetector::detectQuadrilaterals(bool skipCheck)
 {
+	edgeSupport.build(lineDetector.getCanny());
+
 #ifdef ROMANONI
-	ProbQuadDetector quadrilateralDetector(quadParams);
-	quadrilateralDetector.detect(*verticalLines, *horizontalLines, lineDetector.getCanny());
+	quadDetector->detect(detections.verticalLines, detections.horizontalLines,
+				edgeSupport, detections.rectangles, detections.points);
 #else
 	CornerClassifier cornerClassifier(cornerParams, lineDetector.getCanny(),
-				roll);
+				roll, &edgeSupport);
 	QuadrilateralDetector quadrilateralDetector(quadParams, cornerClassifier);
-	quadrilateralDetector.detect(*verticalLines, *horizontalLines, true);
+	quadrilateralDetector.detect(detections.verticalLines,
+				detections.horizontalLines, true);
+
+	//move the detections into the arena
+	std::vector<Rectangle>* rectangles = quadrilateralDetector.getRectangles();
+	std::vector<Pole>* poles = quadrilateralDetector.getPoles();
+	detections.rectangles.swap(*rectangles);
+	detections.poles.swap(*poles);
+	delete rectangles;
+	delete poles;
 #endif
-
-	rectangles = quadrilateralDetector.getRectangles();
-	poles = quadrilateralDetector.getPoles();
-	points = quadrilateralDetector.getPoints();
 }
 
 BasicDetector::~BasicDetector()
 {
-
+#ifdef ROMANONI
+	delete quadDetector;
+#endif
 }
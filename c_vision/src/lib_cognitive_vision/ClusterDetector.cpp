@@ -32,21 +32,22 @@ ClusterDetector::ClusterDetector(ClusterParam& params) :
 {
 }
 
-vector<Cluster>* ClusterDetector::detect(Mat& input, const Mat& mask)
+void ClusterDetector::detect(Mat& input, vector<Cluster>& clusters,
+			const Mat& mask)
 {
-	vector<KeyPoint> keyPoints;
-
-	Mat roi;
+	keyPoints.clear();
 
 	if(mask.empty())
 	{
-		roi = input;
+		FAST(input, keyPoints, params.threshold);
 	}
 	else
 	{
+		roi.create(input.size(), input.type());
+		roi.setTo(Scalar(0));
 		input.copyTo(roi, mask);
+		FAST(roi, keyPoints, params.threshold);
 	}
 
-	FAST(roi, keyPoints, params.threshold);
-	return clustering.detect(keyPoints);
+	clustering.detect(keyPoints, clusters);
 }
@@ -120,8 +120,8 @@ bool CornerResult::isCompatible(CornerType type)
 }
 
 CornerClassifier::CornerClassifier(CornerClassParam& params, const Mat& canny,
-			double roll) :
-			params(params), canny(canny)
+			double roll, const EdgeSupport* edges) :
+			params(params), canny(canny), edges(edges)
 {
 	//TODO check if the roll sign id correct
 	sinR = std::sin(-roll);
@@ -130,6 +130,19 @@ CornerClassifier::CornerClassifier(CornerClassParam& params, const Mat& canny,
 
 CornerResult CornerClassifier::getResult(const Point& point)
 {
+	//a window without edges always gives an empty histogram
+	if (edges)
+	{
+		int minX = max(0, point.x - params.kernelSize);
+		int maxX = min(canny.cols, point.x + params.kernelSize);
+		int minY = max(0, point.y - params.kernelSize);
+		int maxY = min(canny.rows, point.y + params.kernelSize);
+
+		if (maxX <= minX || maxY <= minY
+					|| edges->count(minX, minY, maxX - minX, maxY - minY) == 0)
+			return CornerResult(EMPTY);
+	}
+
 	Mat hist;
 	computeHistogram(point, hist);
 	CornerType type = findNearestNeighbour(hist);
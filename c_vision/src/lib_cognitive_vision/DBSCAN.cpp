@@ -22,7 +22,8 @@
  */
 
 #include "DBSCAN.h"
-#include <set>
+#include <algorithm>
+#include <limits>
 
 using namespace std;
 using namespace cv;
@@ -30,24 +31,32 @@ using namespace cv;
 DBSCAN::DBSCAN(double& eps, int& minPts) :
 			maxDistance(eps), minPoints(minPts)
 {
+	gridColumns = 0;
+	gridRows = 0;
+	cellSize = 1;
+	minX = 0;
+	minY = 0;
 }
 
-std::vector<Cluster>* DBSCAN::detect(const vector<KeyPoint>& keypoints)
+void DBSCAN::detect(const vector<KeyPoint>& keypoints,
+			vector<Cluster>& clusters)
 {
-	vector<Cluster>* clustersPointer = new vector<Cluster>();
-	vector<Cluster>& clusters = *clustersPointer;
-	set<int> clustered;
-	set<int> visited;
-
 	int keyPointsNumber = keypoints.size();
+	visited.assign(keyPointsNumber, false);
+	clustered.assign(keyPointsNumber, false);
+
+	buildGrid(keypoints);
 
-	for (size_t i = 0; i < keyPointsNumber; i++)
+	vector<int> neighbor;
+	vector<int> newNeighbors;
+
+	for (int i = 0; i < keyPointsNumber; i++)
 	{
 		//consider unvisited points
-		if (!visited.count(i))
+		if (!visited[i])
 		{
-			visited.insert(i);
-			vector<int> neighbor = listNeighbors(keypoints, keypoints[i]);
+			visited[i] = true;
+			listNeighbors(keypoints, i, neighbor);
 
 			//create new cluster
 			if (neighbor.size() >= minPoints)
@@ -55,17 +64,18 @@ std::vector<Cluster>* DBSCAN::detect(const vector<KeyPoint>& keypoints)
 				Cluster currentCluster;
 				KeyPoint pt = keypoints[i];
 				currentCluster.add(pt);
-				clustered.insert(i);
+				clustered[i] = true;
 
 				//expand cluster
 				for (size_t j = 0; j < neighbor.size(); j++)
 				{
+					int current = neighbor[j];
+
 					//search all reachable points
-					if (!visited.count(neighbor[j]))
+					if (!visited[current])
 					{
-						visited.insert(neighbor[j]);
-						const vector<int>& newNeighbors = listNeighbors(
-									keypoints, keypoints[neighbor[j]]);
+						visited[current] = true;
+						listNeighbors(keypoints, current, newNeighbors);
 						if (newNeighbors.size() >= minPoints)
 						{
 							neighbor.insert(neighbor.end(),
@@ -75,10 +85,10 @@ std::vector<Cluster>* DBSCAN::detect(const vector<KeyPoint>& keypoints)
 					}
 
 					// add new points to cluster
-					if (!clustered.count(neighbor[j]))
+					if (!clustered[current])
 					{
-						clustered.insert(j);
-						KeyPoint p = keypoints[neighbor[j]];
+						clustered[current] = true;
+						KeyPoint p = keypoints[current];
 						currentCluster.add(p);
 					}
 				}
@@ -88,25 +98,89 @@ std::vector<Cluster>* DBSCAN::detect(const vector<KeyPoint>& keypoints)
 
 		}
 	}
+}
+
+void DBSCAN::buildGrid(const vector<KeyPoint>& keypoints)
+{
+	//the distance truncates the coordinates, so neighbors may be up to one pixel farther
+	cellSize = maxDistance + 1;
+
+	minX = numeric_limits<float>::max();
+	minY = numeric_limits<float>::max();
+	float maxX = -numeric_limits<float>::max();
+	float maxY = -numeric_limits<float>::max();
+
+	for (auto& keypoint : keypoints)
+	{
+		minX = min(minX, keypoint.pt.x);
+		minY = min(minY, keypoint.pt.y);
+		maxX = max(maxX, keypoint.pt.x);
+		maxY = max(maxY, keypoint.pt.y);
+	}
+
+	if (keypoints.empty())
+	{
+		gridColumns = 0;
+		gridRows = 0;
+		return;
+	}
+
+	gridColumns = (maxX - minX) / cellSize + 1;
+	gridRows = (maxY - minY) / cellSize + 1;
 
-	return clustersPointer;
+	//counting sort of the points by cell
+	cellStart.assign(gridColumns * gridRows + 1, 0);
+	pointCells.resize(keypoints.size());
+
+	for (size_t i = 0; i < keypoints.size(); i++)
+	{
+		int column = (keypoints[i].pt.x - minX) / cellSize;
+		int row = (keypoints[i].pt.y - minY) / cellSize;
+		pointCells[i] = row * gridColumns + column;
+		cellStart[pointCells[i] + 1]++;
+	}
+
+	for (size_t c = 1; c < cellStart.size(); c++)
+		cellStart[c] += cellStart[c - 1];
+
+	cellPoints.resize(keypoints.size());
+	vector<int> next(cellStart.begin(), cellStart.end() - 1);
+
+	for (size_t i = 0; i < keypoints.size(); i++)
+		cellPoints[next[pointCells[i]]++] = i;
 }
 
-vector<int> DBSCAN::listNeighbors(const vector<KeyPoint>& keypoints,
-			const KeyPoint& keypoint)
+void DBSCAN::listNeighbors(const vector<KeyPoint>& keypoints, int index,
+			vector<int>& neighbors)
 {
+	const KeyPoint& keypoint = keypoints[index];
+	int column = pointCells[index] % gridColumns;
+	int row = pointCells[index] / gridColumns;
+
 	float dist;
-	vector<int> neighbors;
-	for (int i = 0; i < keypoints.size(); i++)
+	neighbors.clear();
+
+	//only the adjacent cells can hold points within maxDistance
+	for (int r = max(0, row - 1); r <= min(gridRows - 1, row + 1); r++)
 	{
-		int dx = keypoint.pt.x - keypoints[i].pt.x;
-		int dy = keypoint.pt.y - keypoints[i].pt.y;
-		dist = dx * dx + dy * dy;
-		if (dist <= maxDistance * maxDistance && dist != 0.0f)
+		for (int c = max(0, column - 1); c <= min(gridColumns - 1, column + 1);
+					c++)
 		{
-			neighbors.push_back(i);
+			int cell = r * gridColumns + c;
+			for (int k = cellStart[cell]; k < cellStart[cell + 1]; k++)
+			{
+				int i = cellPoints[k];
+				int dx = keypoint.pt.x - keypoints[i].pt.x;
+				int dy = keypoint.pt.y - keypoints[i].pt.y;
+				dist = dx * dx + dy * dy;
+				if (dist <= maxDistance * maxDistance && dist != 0.0f)
+				{
+					neighbors.push_back(i);
+				}
+			}
 		}
 	}
-	return neighbors;
-}
 
+	//same expansion order as a scan of all the points
+	sort(neighbors.begin(), neighbors.end());
+}
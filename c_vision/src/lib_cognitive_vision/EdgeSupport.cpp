@@ -0,0 +1,36 @@
+/*
+ * c_vision,
+ *
+ *
+ * Copyright (C) 2014 Davide Tateo
+ * Versione 1.0
+ *
+ * This file is part of c_vision.
+ *
+ * c_vision is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * c_vision is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with c_vision.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "EdgeSupport.h"
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+using namespace cv;
+
+void EdgeSupport::build(const Mat& edges)
+{
+	//buffers are reallocated only when the frame size changes
+	threshold(edges, binary, 0, 1, THRESH_BINARY);
+	integral(binary, sum, CV_32S);
+}
@@ -30,10 +30,21 @@
 #include <opencv2/imgproc/imgproc.hpp>
 
 #include <iostream>
+#include <climits>
+#include <cfloat>
+#include <cmath>
 
 using namespace std;
 using namespace cv;
 
+//canny accepts precomputed gradients since OpenCV 3.2
+#if CV_MAJOR_VERSION > 3 || (CV_MAJOR_VERSION == 3 && CV_MINOR_VERSION >= 2)
+#define CANNY_GRADIENTS
+#endif
+
+const vector<uchar> LineDetector::magnitudeTable(
+			LineDetector::initMagnitudeTable());
+
 LineDetector::LineDetector(CannyParam& cannyP, HoughParam& houghP,
 			LFilterParam& filterP) :
 			cannyP(cannyP), houghP(houghP), filterP(filterP)
@@ -42,10 +53,10 @@ LineDetector::LineDetector(CannyParam& cannyP, HoughParam& houghP,
 	verticalLines = NULL;
 }
 
-void LineDetector::detect(Mat& input, double roll, const cv::Mat& mask)
+void LineDetector::detect(Mat& input, double roll,
+			vector<Vec4i>& verticalLines, vector<Vec4i>& horizontalLines,
+			const cv::Mat& mask)
 {
-	Mat tmp, blurred;
-
 	double high_thres;
 	double low_thres;
 
@@ -55,12 +66,27 @@ void LineDetector::detect(Mat& input, double roll, const cv::Mat& mask)
 	//bilateralFilter(input, blurred, 5, 100, 100);
 
 	GaussianBlur(input, blurred, cv::Size(0, 0), 6);
-	addWeighted(input, 1.5, blurred, -0.5, 0, tmp);
-	bilateralFilter(tmp, blurred, 5, 150, 150);
+	addWeighted(input, 1.5, blurred, -0.5, 0, sharpened);
+	bilateralFilter(sharpened, filtered, 5, 150, 150);
+
+#ifdef CANNY_GRADIENTS
+	//the 7x7 canny rescales its thresholds, so it computes its own gradients
+	bool shareGradients = cannyP.apertureSize < 7;
+#else
+	bool shareGradients = false;
+#endif
+
+	if (cannyP.automatic || shareGradients)
+	{
+		Sobel(filtered, dx, CV_16S, 1, 0, cannyP.apertureSize, 1, 0,
+					BORDER_REPLICATE);
+		Sobel(filtered, dy, CV_16S, 0, 1, cannyP.apertureSize, 1, 0,
+					BORDER_REPLICATE);
+	}
 
 	if (cannyP.automatic)
 	{
-		high_thres = 0.8*computeThreshold(blurred);
+		high_thres = 0.8*computeThreshold(dx, dy);
 		low_thres = high_thres * cannyP.alpha;
 	}
 	else
@@ -69,29 +95,35 @@ void LineDetector::detect(Mat& input, double roll, const cv::Mat& mask)
 		low_thres = cannyP.low;
 	}
 
-	Canny(blurred, tmp, low_thres, high_thres, cannyP.apertureSize, true);
+#ifdef CANNY_GRADIENTS
+	if (shareGradients)
+		Canny(dx, dy, edges, low_thres, high_thres, true);
+	else
+#endif
+		Canny(filtered, edges, low_thres, high_thres, cannyP.apertureSize, true);
 
 	if (mask.empty())
 	{
-		canny = tmp;
+		edges.copyTo(canny);
 		maskImage(canny);
 	}
 	else
 	{
-		canny = Mat(tmp.rows, tmp.cols, CV_8UC1,Scalar(0));
-		tmp.copyTo(canny, mask);
+		canny.create(edges.rows, edges.cols, CV_8UC1);
+		canny.setTo(Scalar(0));
+		edges.copyTo(canny, mask);
 	}
 
-	vector<Vec4i> lines;
+	lines.clear();
 
 	HoughLinesP(canny, lines, houghP.rho, houghP.teta, houghP.threshold,
 				houghP.minLineLenght, houghP.maxLineGap);
 
 	/* Filter Lines */
 	LineFilter filter(filterP);
-	filter.filter(lines, roll);
-	verticalLines = filter.getVerticalLines();
-	horizontalLines = filter.getHorizontalLines();
+	filter.filter(lines, roll, verticalLines, horizontalLines);
+	this->verticalLines = &verticalLines;
+	this->horizontalLines = &horizontalLines;
 
 }
 
@@ -106,22 +138,69 @@ void LineDetector::display()
 	viewer.setImage(colored);
 }
 
-int LineDetector::computeThreshold(cv::Mat& src)
+int LineDetector::computeThreshold(const Mat& dx, const Mat& dy)
 {
-	Mat tmp;
+	//histogram of the gradient magnitude, without the intermediate images
+	int hist[256] = { 0 };
+
+	for (int i = 0; i < dx.rows; i++)
+	{
+		const short* px = dx.ptr<short>(i);
+		const short* py = dy.ptr<short>(i);
+
+		for (int j = 0; j < dx.cols; j++)
+		{
+			//same saturation of the 16 bit squares and sum
+			int x2 = min(px[j] * px[j], SHRT_MAX);
+			int y2 = min(py[j] * py[j], SHRT_MAX);
+			hist[magnitudeTable[min(x2 + y2, SHRT_MAX)]]++;
+		}
+	}
 
-	Mat dx, dy, g2, g;
-	Sobel(src, dx, CV_16S, 1, 0, cannyP.apertureSize, 1, 0, BORDER_REPLICATE);
-	Sobel(src, dy, CV_16S, 0, 1, cannyP.apertureSize, 1, 0, BORDER_REPLICATE);
+	//otsu threshold, as computed by cv::threshold
+	double scale = 1.0 / (dx.rows * dx.cols);
+	double mu = 0;
 
-	g2 = dx.mul(dx) + dy.mul(dy);
+	for (int i = 0; i < 256; i++)
+		mu += i * (double) hist[i];
 
-	g2.convertTo(g2, CV_64F);
-	sqrt(g2, g);
-	g.convertTo(g, CV_8UC1);
+	mu *= scale;
+
+	double mu1 = 0, q1 = 0;
+	double maxSigma = 0, maxValue = 0;
+
+	for (int i = 0; i < 256; i++)
+	{
+		double p = hist[i] * scale;
+		mu1 *= q1;
+		q1 += p;
+		double q2 = 1.0 - q1;
+
+		if (min(q1, q2) < FLT_EPSILON || max(q1, q2) > 1.0 - FLT_EPSILON)
+			continue;
+
+		mu1 = (mu1 + i * p) / q1;
+		double mu2 = (mu - q1 * mu1) / q2;
+		double sigma = q1 * q2 * (mu1 - mu2) * (mu1 - mu2);
+
+		if (sigma > maxSigma)
+		{
+			maxSigma = sigma;
+			maxValue = i;
+		}
+	}
+
+	return maxValue;
+}
+
+vector<uchar> LineDetector::initMagnitudeTable()
+{
+	vector<uchar> table(SHRT_MAX + 1);
 
-	return threshold(g, tmp, 0, 255, CV_THRESH_BINARY + CV_THRESH_OTSU);
+	for (int v = 0; v <= SHRT_MAX; v++)
+		table[v] = saturate_cast<uchar>(std::sqrt(static_cast<double>(v)));
 
+	return table;
 }
 
 void LineDetector::maskImage(Mat& canny)
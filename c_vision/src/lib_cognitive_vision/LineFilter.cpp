@@ -37,11 +37,10 @@ using namespace std;
 LineFilter::LineFilter(LFilterParam& filterP) :
 			filterP(filterP)
 {
-	verticalLines = new vector<Vec4i>();
-	horizontalLines = new vector<Vec4i>();
 }
 
-void LineFilter::filter(vector<Vec4i>& lines, double roll)
+void LineFilter::filter(vector<Vec4i>& lines, double roll,
+			vector<Vec4i>& verticalLines, vector<Vec4i>& horizontalLines)
 {
 	const double delta_max_vertical = from_degrees(filterP.maxDeltaVertical);
 	const double delta_max_horizontal = from_degrees(
@@ -63,19 +62,19 @@ void LineFilter::filter(vector<Vec4i>& lines, double roll)
 		{
 			ROS_DEBUG_STREAM(
 						"linea: " << to_degrees(alpha_line) << " orizzontale: " << roll << " distanza: " << to_degrees(shortest_angular_distance(alpha_line, horizontal_line)));
-			horizontalLines->push_back(lines[i]);
+			horizontalLines.push_back(lines[i]);
 		}
 		//e' verticale
 		else if (sameSlope(alpha_line, vertical_line, delta_max_vertical))
 		{
 			ROS_DEBUG_STREAM(
 						"linea: " << to_degrees(alpha_line) << " verticale: " << roll + 90 << " distanza: " << to_degrees(shortest_angular_distance(alpha_line, vertical_line)));
-			verticalLines->push_back(lines[i]);
+			verticalLines.push_back(lines[i]);
 		}
 	}
 
-	sort(verticalLines->begin(), verticalLines->end(), isLeftmostLine);
-	sort(horizontalLines->begin(), horizontalLines->end(), isHighestLine);
+	sort(verticalLines.begin(), verticalLines.end(), isLeftmostLine);
+	sort(horizontalLines.begin(), horizontalLines.end(), isHighestLine);
 
 }
 
@@ -23,6 +23,8 @@
 
 #include "ObjectClassificator.h"
 
+#include <stdexcept>
+
 //FIXME levami
 //#include "performances/PerformanceEstimator.h"
 //FIXME
@@ -32,10 +34,20 @@ using namespace std;
 
 ObjectClassificator::ObjectClassificator(Classification& classification,
 			ClassifierParam& params) :
-			classification(classification),
+			results(&classification.response.results),
 			objects(classification.request.objects)
 {
 	classification.request.threshold = params.threshold;
+	classification.request.topK = params.topK;
+	currentVars = NULL;
+}
+
+ObjectClassificator::ObjectClassificator(ClassificationGroup& group,
+			ClassifierParam& params) :
+			results(NULL), objects(group.objects)
+{
+	group.threshold = params.threshold;
+	group.topK = params.topK;
 	currentVars = NULL;
 }
 
@@ -72,8 +84,16 @@ void ObjectClassificator::addFeature(Feature& feature)
 
 void ObjectClassificator::labelFeatures()
 {
-	vector<ObjectClassification>& results = classification.response.results;
+	//groups are labeled with the results of the batch response
+	if (!results)
+		throw runtime_error(
+					"Classification group results must be passed explicitly");
+
+	labelFeatures(*results);
+}
 
+void ObjectClassificator::labelFeatures(vector<ObjectClassification>& results)
+{
 	//FIXME LEVARE
 	//pe->processNewFrame();
 	//FIXME
@@ -25,7 +25,10 @@
 
 #include <angles/angles.h>
 #include <ros/ros.h>
+#include <opencv2/core/core.hpp>
 #include <vector>
+#include <thread>
+#include <algorithm>
 
 using namespace std;
 
@@ -52,6 +55,32 @@ ParameterServer::ParameterServer()
 		throw runtime_error("No imu source specified");
 	}
 
+	classifier.inProcess = false;
+	ros::param::get("classifier_in_process", classifier.inProcess);
+
+	if (classifier.inProcess)
+	{
+		if (!ros::param::get("classifier_knowledgebase", classifier.knowledgeBase)
+					|| !ros::param::get("classifier_rules", classifier.rules))
+			throw runtime_error("No in-process classifier specified");
+	}
+
+	classifier.compact = false;
+	ros::param::get("classifier_compact", classifier.compact);
+
+	//tracks of the same frame are detected in parallel on the OpenCV pool.
+	//The quad_threads sampling of a detector is nested in that region and
+	//shares the same pool, so the two never multiply the threads; workers
+	//past the pool size would only sit idle
+	recognizerWorkers = thread::hardware_concurrency();
+	ros::param::get("~recognizer_workers", recognizerWorkers);
+	recognizerWorkers = max(1, min(recognizerWorkers, cv::getNumThreads()));
+
+	//decoded frames kept by the recognizer, in megabytes
+	int imageCacheSize = 32;
+	ros::param::get("~image_cache_size", imageCacheSize);
+	imageCacheBudget = static_cast<size_t>(max(1, imageCacheSize)) << 20;
+
 	quadDetector.K;
 	quadDetector.K << K_std[0], K_std[1], K_std[2],
 	/*              */K_std[3], K_std[4], K_std[5],
@@ -87,6 +116,9 @@ void ParameterServer::update(c_vision::ParametersConfig &config, uint32_t level)
 	quadDetector.threshold = config.quad_threshold;
 	quadDetector.maxDistance = config.quad_maxDistance;
 	quadDetector.minPoints = config.quad_minPoints;
+	quadDetector.seed = config.quad_seed;
+	quadDetector.threads = config.quad_threads;
+	quadDetector.sampling = static_cast<SamplingStrategy>(config.quad_sampling);
 
 	//set up corner classifier params
 	cornerClass.kernelSize = config.corner_kernelSize;
@@ -99,6 +131,9 @@ void ParameterServer::update(c_vision::ParametersConfig &config, uint32_t level)
 
 	//Setup classifier parameters
 	classifier.threshold = config.classifier_threshold;
+	classifier.topK = config.classifier_topK;
+	classifier.maxInFlight = config.classifier_maxInFlight;
+	classifier.deadline = config.classifier_deadline;
 
 	//Setup display params
 	display.currentObject = config.displayer_currentObject;
@@ -23,33 +23,36 @@
 
 #include "ProbQuadDetector.h"
 #include <random>
+#include <algorithm>
+#include <limits>
+#include <cmath>
 #include "../../include/lib_cognitive_vision/Lines.h"
 
 using namespace cv;
 using namespace std;
 
-std::random_device ProbQuadDetector::rd;
-std::mt19937 ProbQuadDetector::gen(ProbQuadDetector::rd());
-
 ProbQuadDetector::ProbQuadDetector(QDetectorParam& quadP) :
 			quadP(quadP)
 {
-	rectangles = new vector<Rectangle>();
-	poles = new vector<Pole>();
-
-	//TODO delete
-	points = new vector<Point>();
+	horizontalCount = 0;
+	denseVotes = true;
+	frameSeed = 0;
+	haltonShift[0] = 0;
+	haltonShift[1] = 0;
+	gridColumns = 1;
+	gridRows = 1;
+	blockColumns = 1;
 }
 
 unsigned int ProbQuadDetector::sampleCoordinate(unsigned int lo,
-			unsigned int hi)
+			unsigned int hi, SampleGenerator& gen)
 {
 	std::uniform_real_distribution<> dist(lo, hi);
 	return dist(gen);
 }
 
 bool ProbQuadDetector::crispScore(unsigned int x, unsigned int y,
-			Vec4i& h1, Vec4i& h2, Vec4i& v1, Vec4i& v2, const Mat& canny)
+			Vec4i& h1, Vec4i& h2, Vec4i& v1, Vec4i& v2, const EdgeSupport& edges)
 {
 	Vec2d p[4];
 	p[0] = Lines::projectPoint(x, y, h1);
@@ -62,14 +65,12 @@ bool ProbQuadDetector::crispScore(unsigned int x, unsigned int y,
 		int xp = p[i][0];
 		int yp = p[i][1];
 
-		int xr = std::min(std::max(0, xp-2), canny.cols-1);
-		int yr = std::min(std::max(0, yp-2), canny.rows-1);
-		int w = std::min(canny.cols - xr, 4);
-		int h = std::min(canny.rows - yr, 4);
+		int xr = std::min(std::max(0, xp-2), edges.getWidth()-1);
+		int yr = std::min(std::max(0, yp-2), edges.getHeight()-1);
+		int w = std::min(edges.getWidth() - xr, 4);
+		int h = std::min(edges.getHeight() - yr, 4);
 
-		Rect roi(xr, yr, w, h);
-
-		if(countNonZero(canny(roi)) == 0)
+		if(edges.count(xr, yr, w, h) == 0)
 			return false;
 
 	}
@@ -77,6 +78,247 @@ bool ProbQuadDetector::crispScore(unsigned int x, unsigned int y,
 	return true;
 }
 
+void ProbQuadDetector::prepareWorkers(size_t verticalCount,
+			size_t horizontalCount)
+{
+	workers.resize(max(1, quadP.threads));
+
+	//each vertical line is paired with the next two only
+	this->horizontalCount = horizontalCount;
+	size_t size = verticalCount * 2 * horizontalCount * horizontalCount;
+	size_t maxSize = MAX_DENSE_CELLS / workers.size();
+	denseVotes = size <= maxSize;
+
+	for (size_t t = 0; t < workers.size(); t++)
+	{
+		SampleWorker& worker = workers[t];
+
+		//the dense accumulators never grow past the cap
+		if (worker.votes.capacity() > maxSize)
+			vector<VoteCell>().swap(worker.votes);
+
+		if (denseVotes && worker.votes.size() < size)
+		{
+			VoteCell empty = { 0, 0 };
+			worker.votes.resize(size, empty);
+		}
+
+		worker.points.clear();
+	}
+}
+
+double ProbQuadDetector::radicalInverse(unsigned int n, unsigned int base)
+{
+	double inverse = 0;
+	double digit = 1.0 / base;
+
+	for (; n > 0; n /= base, digit /= base)
+		inverse += (n % base) * digit;
+
+	return inverse;
+}
+
+void ProbQuadDetector::prepareSampling(const EdgeSupport& edges)
+{
+	int width = edges.getWidth();
+	int height = edges.getHeight();
+
+	//sample n draws from (frameSeed, n + 1), whatever worker takes it
+	if (quadP.seed != 0)
+		frameSeed = static_cast<unsigned int>(quadP.seed);
+	else
+		frameSeed = rd();
+
+	switch (quadP.sampling)
+	{
+		case HALTON_SAMPLING:
+		{
+			//a random shift per frame, so that the frames see different points
+			SampleGenerator gen(frameSeed, 0);
+			uniform_real_distribution<> dist(0, 1);
+			haltonShift[0] = dist(gen);
+			haltonShift[1] = dist(gen);
+			break;
+		}
+
+		case STRATIFIED_SAMPLING:
+		{
+			//about one square cell per sample
+			double ratio = static_cast<double>(width) / max(1, height);
+			gridColumns = max(1, cvRound(sqrt(quadP.points * ratio)));
+			gridRows = max(1, (quadP.points + gridColumns - 1) / gridColumns);
+			break;
+		}
+
+		case EDGE_SAMPLING:
+		{
+			//the edges around a block, plus one to reach every block
+			blockColumns = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			int blockRows = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			blockWeights.resize(blockColumns * blockRows);
+
+			unsigned int total = 0;
+			for (int by = 0; by < blockRows; by++)
+			{
+				for (int bx = 0; bx < blockColumns; bx++)
+				{
+					int x0 = max(0, (bx - 1) * BLOCK_SIZE);
+					int y0 = max(0, (by - 1) * BLOCK_SIZE);
+					int x1 = min(width, (bx + 2) * BLOCK_SIZE);
+					int y1 = min(height, (by + 2) * BLOCK_SIZE);
+
+					total += edges.count(x0, y0, x1 - x0, y1 - y0) + 1;
+					blockWeights[by * blockColumns + bx] = total;
+				}
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+Point ProbQuadDetector::samplePoint(int n, const EdgeSupport& edges)
+{
+	unsigned int width = edges.getWidth();
+	unsigned int height = edges.getHeight();
+	SampleGenerator gen(frameSeed, n + 1);
+
+	switch (quadP.sampling)
+	{
+		case HALTON_SAMPLING:
+		{
+			double u = radicalInverse(n + 1, 2) + haltonShift[0];
+			double v = radicalInverse(n + 1, 3) + haltonShift[1];
+			u -= floor(u);
+			v -= floor(v);
+			return Point(u * (width - 1), v * (height - 1));
+		}
+
+		case STRATIFIED_SAMPLING:
+		{
+			int cell = n % (gridColumns * gridRows);
+			uniform_real_distribution<> dist(0, 1);
+			double u = (cell % gridColumns + dist(gen)) / gridColumns;
+			double v = (cell / gridColumns + dist(gen)) / gridRows;
+			return Point(u * (width - 1), v * (height - 1));
+		}
+
+		case EDGE_SAMPLING:
+		{
+			uniform_int_distribution<unsigned int> dist(0, blockWeights.back() - 1);
+			size_t block = upper_bound(blockWeights.begin(), blockWeights.end(),
+						dist(gen)) - blockWeights.begin();
+
+			unsigned int x0 = (block % blockColumns) * BLOCK_SIZE;
+			unsigned int y0 = (block / blockColumns) * BLOCK_SIZE;
+			unsigned int x1 = min<unsigned int>(x0 + BLOCK_SIZE, width) - 1;
+			unsigned int y1 = min<unsigned int>(y0 + BLOCK_SIZE, height) - 1;
+			return Point(sampleCoordinate(x0, x1, gen),
+						sampleCoordinate(y0, y1, gen));
+		}
+
+		default:
+			return Point(sampleCoordinate(0, width - 1, gen),
+						sampleCoordinate(0, height - 1, gen));
+	}
+}
+
+void ProbQuadDetector::sample(SampleWorker& worker, int begin, int samples,
+			vector<Vec4i>& verticalLines, vector<Vec4i>& horizontalLines,
+			const EdgeSupport& edges)
+{
+	for (int n = begin; n < begin + samples; n++)
+	{
+		Point p = samplePoint(n, edges);
+
+		voteRectangles(worker, p.x, p.y, verticalLines, horizontalLines, edges);
+
+		//TODO delete me
+		worker.points.push_back(p);
+	}
+}
+
+ProbQuadDetector::SampleBody::SampleBody(ProbQuadDetector& detector,
+			vector<Vec4i>& verticalLines, vector<Vec4i>& horizontalLines,
+			const EdgeSupport& edges) :
+			detector(detector), verticalLines(verticalLines),
+			horizontalLines(horizontalLines), edges(edges)
+{
+}
+
+void ProbQuadDetector::SampleBody::operator()(const Range& range) const
+{
+	int count = detector.workers.size();
+	int share = detector.quadP.points / count;
+	int remainder = detector.quadP.points % count;
+
+	for (int t = range.start; t < range.end; t++)
+	{
+		int begin = t * share + min(t, remainder);
+		int samples = share + (t < remainder ? 1 : 0);
+		detector.sample(detector.workers[t], begin, samples, verticalLines,
+					horizontalLines, edges);
+	}
+}
+
+void ProbQuadDetector::reduceVotes()
+{
+	//merge in worker order, into the first accumulator
+	SampleWorker& result = workers[0];
+
+	for (size_t t = 1; t < workers.size(); t++)
+	{
+		SampleWorker& worker = workers[t];
+
+		for (auto index : worker.touched)
+		{
+			VoteCell& cell = getCell(worker, index);
+			VoteCell& total = getCell(result, index);
+
+			if (total.total == 0)
+				result.touched.push_back(index);
+
+			total.hits += cell.hits;
+			total.total += cell.total;
+
+			cell.hits = 0;
+			cell.total = 0;
+		}
+
+		worker.touched.clear();
+		worker.sparseVotes.clear();
+
+		result.points.insert(result.points.end(), worker.points.begin(),
+					worker.points.end());
+	}
+}
+
+inline ProbQuadDetector::VoteCell& ProbQuadDetector::getCell(
+			SampleWorker& worker, size_t index)
+{
+	if (denseVotes)
+		return worker.votes[index];
+
+	//new cells are value initialized, so they start empty
+	return worker.sparseVotes[index];
+}
+
+inline void ProbQuadDetector::voteCell(SampleWorker& worker, size_t i,
+			size_t k1, size_t j, size_t k2, bool ok)
+{
+	size_t index = ((i * 2 + k1 - i - 1) * horizontalCount + j)
+				* horizontalCount + k2;
+	VoteCell& cell = getCell(worker, index);
+
+	if (cell.total == 0)
+		worker.touched.push_back(index);
+
+	cell.hits += ok ? 1 : 0;
+	cell.total++;
+}
+
 double ProbQuadDetector::fuzzyScore(unsigned int x, unsigned int y,
 			Vec4i& h1, Vec4i& h2, Vec4i& v1, Vec4i& v2)
 {
@@ -97,48 +339,46 @@ double ProbQuadDetector::fuzzyScore(unsigned int x, unsigned int y,
 	return score;
 }
 
-void ProbQuadDetector::voteRectangles(unsigned int x, unsigned int y,
+void ProbQuadDetector::voteRectangles(SampleWorker& worker, unsigned int x,
+			unsigned int y,
 			std::vector<cv::Vec4i>& verticalLines,
 			std::vector<cv::Vec4i>& horizontalLines,
-			const cv::Mat& canny)
+			const EdgeSupport& edges)
 {
-	for (size_t i = 0; i + 1 < verticalLines.size(); i++)
+	//only the lines above and below the sample can be used
+	size_t aboveEnd = lower_bound(aboveLines.begin(), aboveLines.end(),
+				make_pair(y, size_t(0))) - aboveLines.begin();
+	size_t belowBegin = upper_bound(belowLines.begin(), belowLines.end(),
+				make_pair(y, numeric_limits<size_t>::max())) - belowLines.begin();
+
+	for (auto& linePair : pairBuckets[x / BUCKET_WIDTH])
 	{
-		//i+1 instead size-1 to avoid integer overflow
+		size_t i = linePair.first;
+		size_t k1 = linePair.second;
 		Vec4i& v1 = verticalLines[i];
-		if (Lines::atLeft(v1, x))
+		Vec4i& v2 = verticalLines[k1];
+
+		if (!Lines::atLeft(v1, x) || !Lines::atRight(v2, x))
+			continue;
+
+		unsigned int midLine = Lines::getMidLine(v1, v2);
+
+		for (size_t a = 0; a < aboveEnd; a++)
 		{
-			for (size_t k1 = i + 1; k1 < i + 3 && k1 < verticalLines.size();
-						k1++)
+			size_t j = aboveLines[a].second;
+			Vec4i& h1 = horizontalLines[j];
+			if (j + 1 < horizontalLines.size() && Lines::between_h(v1, v2, h1)
+						&& Lines::above(h1, midLine))
 			{
-				Vec4i& v2 = verticalLines[k1];
-				unsigned int midLine = Lines::getMidLine(v1, v2);
-				if (Lines::atRight(v2, x))
+				for (size_t b = belowBegin; b < belowLines.size(); b++)
 				{
-					for (size_t j = 0; j + 1 < horizontalLines.size(); j++)
+					size_t k2 = belowLines[b].second;
+					Vec4i& h2 = horizontalLines[k2];
+					if (k2 > j && Lines::between_h(v1, v2, h2)
+								&& Lines::below(h2, midLine))
 					{
-						Vec4i& h1 = horizontalLines[j];
-						if (Lines::between_h(v1, v2, h1) && Lines::above(h1, y)
-									&& Lines::above(h1, midLine))
-						{
-							for (size_t k2 = j + 1; k2 < horizontalLines.size();
-										k2++)
-							{
-								Vec4i& h2 = horizontalLines[k2];
-								if (Lines::between_h(v1, v2, h2)
-											&& Lines::below(h2, y)
-											&& Lines::below(h2, midLine))
-								{
-
-									bool ok = crispScore(x, y, h1, h2, v1, v2, canny);
-									double score2 = fuzzyScore(x, y, h1, h2, v1, v2);
-
-									//Dave test
-									votes[i][k1][j][k2] += ok ? 1 : 0;
-									counts[i][k1][j][k2] += 1;
-								}
-							}
-						}
+						bool ok = crispScore(x, y, h1, h2, v1, v2, edges);
+						voteCell(worker, i, k1, j, k2, ok);
 					}
 				}
 			}
@@ -146,54 +386,104 @@ void ProbQuadDetector::voteRectangles(unsigned int x, unsigned int y,
 	}
 }
 
-void ProbQuadDetector::detect(std::vector<cv::Vec4i>& verticalLines,
-			std::vector<cv::Vec4i>& horizontalLines, const Mat& canny)
+void ProbQuadDetector::buildLineIndex(vector<Vec4i>& verticalLines,
+			vector<Vec4i>& horizontalLines, unsigned int width)
 {
+	//the keys use the same unsigned comparisons of Lines
+	size_t buckets = width / BUCKET_WIDTH + 1;
+	pairBuckets.resize(buckets);
+	for (auto& bucket : pairBuckets)
+		bucket.clear();
 
-	for (int n = 0; n < quadP.points; n++)
+	for (size_t i = 0; i + 1 < verticalLines.size(); i++)
 	{
-		unsigned int x = sampleCoordinate(0, canny.cols - 1);
-		unsigned int y = sampleCoordinate(0, canny.rows - 1);
+		Vec4i& v1 = verticalLines[i];
+		unsigned int left = max<unsigned int>(v1[0], v1[2]);
+
+		for (size_t k1 = i + 1; k1 < i + 3 && k1 < verticalLines.size(); k1++)
+		{
+			Vec4i& v2 = verticalLines[k1];
+			unsigned int right = min<unsigned int>(v2[0], v2[2]);
 
-		voteRectangles(x, y, verticalLines, horizontalLines, canny);
+			//samples strictly between the two lines
+			if (width == 0 || left >= width - 1 || left + 1 >= right)
+				continue;
 
-		//TODO delete me
-		Point p(x,y);
-		points->push_back(p);
+			unsigned int first = left + 1;
+			unsigned int last = min(right - 1, width - 1);
+			for (size_t b = first / BUCKET_WIDTH; b <= last / BUCKET_WIDTH; b++)
+				pairBuckets[b].push_back(make_pair(i, k1));
+		}
 	}
 
-	for (auto& pair1 : votes)
+	aboveLines.clear();
+	belowLines.clear();
+	for (size_t j = 0; j < horizontalLines.size(); j++)
 	{
+		Vec4i& h = horizontalLines[j];
+		aboveLines.push_back(make_pair(max<unsigned int>(h[1], h[3]), j));
+		belowLines.push_back(make_pair(min<unsigned int>(h[1], h[3]), j));
+	}
 
-		for (auto& pair2 : pair1.second)
-		{
+	sort(aboveLines.begin(), aboveLines.end());
+	sort(belowLines.begin(), belowLines.end());
+}
 
-			for (auto& pair3 : pair2.second)
-			{
+void ProbQuadDetector::detect(std::vector<cv::Vec4i>& verticalLines,
+			std::vector<cv::Vec4i>& horizontalLines, const EdgeSupport& edges,
+			vector<Rectangle>& rectangles, vector<Point>& points)
+{
+	prepareWorkers(verticalLines.size(), horizontalLines.size());
+	buildLineIndex(verticalLines, horizontalLines, edges.getWidth());
 
-				for (auto& pair4 : pair3.second)
-				{
-					double hits = pair4.second;
-					double tot = counts[pair1.first][pair2.first][pair3.first][pair4.first];
+	prepareSampling(edges);
 
-					if(tot > quadP.minPoints && hits/tot > quadP.threshold)
-					{
-						Vec4i& v1 = verticalLines[pair1.first];
-						Vec4i& v2 = verticalLines[pair2.first];
-						Vec4i& h1 = horizontalLines[pair3.first];
-						Vec4i& h2 = horizontalLines[pair4.first];
+	//split the samples across the workers, on the OpenCV thread pool
+	SampleBody body(*this, verticalLines, horizontalLines, edges);
+	parallel_for_(Range(0, workers.size()), body);
 
-						buildRectangle(v1, v2, h1, h2);
-					}
-				}
-			}
+	reduceVotes();
+
+	//visit the voted quadruples in (i, k1, j, k2) order
+	SampleWorker& result = workers[0];
+	vector<size_t>& touched = result.touched;
+	points.insert(points.end(), workers[0].points.begin(),
+				workers[0].points.end());
+
+	sort(touched.begin(), touched.end());
+
+	for (auto index : touched)
+	{
+		VoteCell& cell = getCell(result, index);
+		double hits = cell.hits;
+		double tot = cell.total;
+
+		if(tot > quadP.minPoints && hits/tot > quadP.threshold)
+		{
+			size_t k2 = index % horizontalCount;
+			size_t j = index / horizontalCount % horizontalCount;
+			size_t pair = index / horizontalCount / horizontalCount;
+			size_t i = pair / 2;
+			size_t k1 = i + 1 + pair % 2;
+
+			Vec4i& v1 = verticalLines[i];
+			Vec4i& v2 = verticalLines[k1];
+			Vec4i& h1 = horizontalLines[j];
+			Vec4i& h2 = horizontalLines[k2];
+
+			buildRectangle(v1, v2, h1, h2, rectangles);
 		}
+
+		cell.hits = 0;
+		cell.total = 0;
 	}
 
+	touched.clear();
+	result.sparseVotes.clear();
 }
 
 void ProbQuadDetector::buildRectangle(cv::Vec4i& v1, cv::Vec4i& v2,
-			cv::Vec4i& h1, cv::Vec4i& h2)
+			cv::Vec4i& h1, cv::Vec4i& h2, vector<Rectangle>& rectangles)
 {
 	Point px, py, pz, pw;
 
@@ -203,5 +493,5 @@ void ProbQuadDetector::buildRectangle(cv::Vec4i& v1, cv::Vec4i& v2,
 	pw = Lines::findInterception(h2, v1);
 
 	Rectangle rectangle(px, py, pz, pw, quadP.omega);
-	rectangles->push_back(rectangle);
+	rectangles.push_back(rectangle);
 }